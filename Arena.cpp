@@ -0,0 +1,136 @@
+/*
+ * File:	Arena.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		arenas.
+ */
+
+# include "Arena.h"
+
+using namespace std;
+
+const size_t FIRST = 256, LIMIT = 65536, ALIGNMENT = alignof(max_align_t);
+
+
+/*
+ * Function:	Arena::Arena (constructor)
+ *
+ * Description:	Initialize this arena to have no blocks yet, so that an
+ *		arena that is never used costs nothing.
+ */
+
+Arena::Arena()
+    : _next(nullptr), _limit(nullptr), _size(0)
+{
+}
+
+
+/*
+ * Function:	Arena::Arena (move constructor)
+ *
+ * Description:	Initialize this arena with the blocks of another, which
+ *		is left empty.
+ */
+
+Arena::Arena(Arena &&that) noexcept
+    : _blocks(move(that._blocks)), _next(that._next), _limit(that._limit),
+      _size(that._size)
+{
+    that._blocks.clear();
+    that._next = that._limit = nullptr;
+    that._size = 0;
+}
+
+
+/*
+ * Function:	Arena::operator = (move assignment)
+ *
+ * Description:	Free the blocks of this arena and take those of another,
+ *		which is left empty.
+ */
+
+Arena &Arena::operator =(Arena &&that) noexcept
+{
+    if (this != &that) {
+	_blocks = move(that._blocks);
+	_next = that._next;
+	_limit = that._limit;
+	_size = that._size;
+
+	that._blocks.clear();
+	that._next = that._limit = nullptr;
+	that._size = 0;
+    }
+
+    return *this;
+}
+
+
+/*
+ * Function:	Arena::allocate
+ *
+ * Description:	Allocate the given number of bytes, suitably aligned for
+ *		any object.  If the current block is full, a new block is
+ *		started, twice as large as the last up to a limit, or just
+ *		large enough for the request if that is larger still.
+ */
+
+void *Arena::allocate(size_t size)
+{
+    char *p;
+
+
+    size = (size + ALIGNMENT - 1) & ~(size_t) (ALIGNMENT - 1);
+
+    if ((size_t) (_limit - _next) < size) {
+	_size = _size == 0 ? FIRST : _size < LIMIT ? _size * 2 : LIMIT;
+
+	if (_size < size)
+	    _size = size;
+
+	_blocks.emplace_back(new char[_size]);
+	_next = _blocks.back().get();
+	_limit = _next + _size;
+    }
+
+    p = _next;
+    _next += size;
+    return p;
+}
+
+
+/*
+ * Function:	Arena::reset
+ *
+ * Description:	Free everything allocated from this arena, keeping only
+ *		its last block for reuse.
+ */
+
+void Arena::reset()
+{
+    if (_blocks.empty())
+	return;
+
+    if (_blocks.size() > 1) {
+	_blocks.front() = move(_blocks.back());
+	_blocks.resize(1);
+    }
+
+    _next = _blocks.front().get();
+    _limit = _next + _size;
+}
+
+
+/*
+ * Function:	Arena::clear
+ *
+ * Description:	Free everything allocated from this arena, along with all
+ *		of its blocks.
+ */
+
+void Arena::clear()
+{
+    _blocks.clear();
+    _next = _limit = nullptr;
+    _size = 0;
+}
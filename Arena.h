@@ -0,0 +1,47 @@
+/*
+ * File:	Arena.h
+ *
+ * Description:	This file contains the class definition for an arena,
+ *		from which the scopes and symbols of one function are
+ *		allocated.  Allocating just moves a pointer along a block,
+ *		and nothing is freed until the whole arena is reset once the
+ *		function has been checked.  The objects in an arena are
+ *		never deleted, so any that need destroying must be destroyed
+ *		by hand before the arena is reset.
+ *
+ *		Resetting an arena keeps its last block, so an arena that
+ *		is reused for each function in turn soon stops allocating
+ *		at all.  An arena may be moved, as when a function whose
+ *		body is checked later on another thread takes its scopes
+ *		with it.
+ */
+
+# ifndef ARENA_H
+# define ARENA_H
+# include <cstddef>
+# include <memory>
+# include <new>
+# include <utility>
+# include <vector>
+
+class Arena {
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char *_next, *_limit;
+    size_t _size;
+
+public:
+    Arena();
+    Arena(Arena &&that) noexcept;
+    Arena &operator =(Arena &&that) noexcept;
+
+    void *allocate(size_t size);
+    void reset();
+    void clear();
+
+    template<class T, class... Args>
+    T *make(Args &&... args) {
+	return new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+};
+
+# endif /* ARENA_H */
@@ -0,0 +1,47 @@
+/*
+ * File:	CompilerContext.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the compiler context.
+ */
+
+# include <sys/mman.h>
+# include "CompilerContext.h"
+
+using namespace std;
+
+thread_local CompilerContext *context = nullptr;
+
+
+/*
+ * Function:	CompilerContext::CompilerContext (constructor)
+ *
+ * Description:	Initialize this context to have no source yet, which is
+ *		read from the standard input unless named.  The first
+ *		line always starts at the beginning of the source.  The
+ *		target is a 64-bit one unless the context is told otherwise.
+ */
+
+CompilerContext::CompilerContext()
+    : name("stdin"), source(nullptr), sourcesize(0), mapped(0),
+      streamed(0), input(-1), lines(1, 0), forgotten(0), streaming(false),
+      numerrors(0), error(0), stopped(false), layout(LP64),
+      outermost(nullptr), definitions(0), lastDefinition(0),
+      parallel(false), nextJob(0), abandoned(false)
+{
+}
+
+
+/*
+ * Function:	CompilerContext::~CompilerContext (destructor)
+ *
+ * Description:	Release the source if it was mapped.  The parser releases
+ *		the scopes it opens, and everything else is owned by the
+ *		members themselves.
+ */
+
+CompilerContext::~CompilerContext()
+{
+    if (mapped > 0)
+	munmap(source, mapped);
+}
@@ -0,0 +1,107 @@
+/*
+ * File:	CompilerContext.h
+ *
+ * Description:	This file contains the definition of the compiler context,
+ *		which holds all of the state of compiling one translation
+ *		unit: its name, source, and the index of its lines, its
+ *		diagnostics sink, identifier table, type table, target data
+ *		layout, tokens, tree, and outermost scope, and the functions
+ *		whose bodies are waiting to be checked in parallel.  Each
+ *		thread works on the context that is current for it, so any
+ *		number of translation units may be compiled at once on
+ *		different threads.  A thread helping with a unit, such as
+ *		one checking some of its functions, makes the unit's context
+ *		current for itself.
+ *
+ *		A context that streams its translation unit keeps only as
+ *		much of it as is needed to check the top-level declaration
+ *		being parsed: each function is forgotten once checked, and
+ *		diagnostics are written out after each declaration.
+ *
+ *		A context stops once its diagnostics sink is full, or if its
+ *		source cannot be read, in which case the system error is kept
+ *		in the context.  Nothing is ever exited on its behalf, since
+ *		the compiler may be a library in another program: whoever is
+ *		compiling the unit decides what to do about it.  The error
+ *		and whether the context has stopped are atomic, since a
+ *		pipelined lexer may stop the context from its own thread.
+ *
+ *		The parser's place in the tokens, the top-level scope, and
+ *		the position of the token being parsed are kept per thread
+ *		rather than per context, since one unit may be parsed on
+ *		several threads at once.  The lexer interface in lexer.h is
+ *		process-wide, so only one context at a time may read tokens
+ *		through it.  A context may instead scan its tokens with
+ *		scanners of its own.
+ */
+
+# ifndef COMPILERCONTEXT_H
+# define COMPILERCONTEXT_H
+# include <atomic>
+# include <deque>
+# include <mutex>
+# include <string>
+# include <string_view>
+# include <unordered_map>
+# include <vector>
+# include "Arena.h"
+# include "Diagnostics.h"
+# include "Scope.h"
+# include "TokenBuffer.h"
+# include "Tree.h"
+
+struct Job {
+    Symbol *function;
+    Scope *scope;
+    Arena arena;
+    unsigned start, body, end;
+    size_t mark;
+    Node node;
+    bool failed;
+    std::vector<Diagnostic> diagnostics;
+};
+
+struct CompilerContext {
+    const char *name;
+    char *source;
+    size_t sourcesize, mapped, streamed;
+    int input;
+    std::vector<char> copy;
+    std::vector<size_t> lines;
+    size_t forgotten;
+    std::mutex indexing;
+    bool streaming;
+
+    Diagnostics diagnostics;
+    int numerrors;
+    std::atomic<int> error;
+    std::atomic<bool> stopped;
+
+    std::deque<std::string> spellings;
+    std::unordered_map<std::string_view, Name> names;
+
+    TypeTable types;
+    DataLayout layout;
+
+    TokenBuffer tokens;
+
+    Scope *outermost;
+    std::vector<bool> defined;
+
+    Tree tree;
+    Node definitions, lastDefinition;
+
+    bool parallel;
+    std::vector<Job> jobs;
+    std::vector<Diagnostic> outside;
+    std::atomic<size_t> nextJob;
+    std::atomic<bool> abandoned;
+    std::mutex grafting;
+
+    CompilerContext();
+    ~CompilerContext();
+};
+
+extern thread_local CompilerContext *context;
+
+# endif /* COMPILERCONTEXT_H */
@@ -0,0 +1,298 @@
+/*
+ * File:	Diagnostics.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the diagnostics sink.
+ */
+
+# include <cstdio>
+# include <cstring>
+# include "Diagnostics.h"
+# include "source.h"
+
+using namespace std;
+
+thread_local vector<Diagnostic> *deferred = nullptr;
+
+enum { MAXMESSAGE = 999 };
+
+static const char *const formats[] = {
+    nullptr,
+
+    "unterminated comment",
+    "integer constant too large",
+    "floating-point constant out of range",
+    "unknown escape sequence in string constant",
+    "escape sequence out of range in string constant",
+    "unknown escape sequence in character constant",
+    "escape sequence out of range in character constant",
+    "multi-character character constant",
+
+    "syntax error at '%s'",
+    "syntax error at end of file",
+
+    "redefinition of '%s'",
+    "redeclaration of '%s'",
+    "conflicting types for '%s'",
+    "'%s' undeclared",
+
+    "break statement not within loop",
+    "invalid return type",
+    "invalid type for test expression",
+    "lvalue required in expression",
+    "invalid operands to binary %s",
+    "invalid operand to unary %s",
+    "invalid operand in sizeof expression",
+    "invalid operand in cast expression",
+    "called object is not a function",
+    "invalid arguments to called function",
+};
+
+
+/*
+ * Function:	Diagnostics::Diagnostics (constructor)
+ *
+ * Description:	Initialize this sink to write plain text without any
+ *		limit and without dropping duplicates.
+ */
+
+Diagnostics::Diagnostics()
+    : _used(0), _format(TEXT), _limit(0), _count(0), _deduplicating(false)
+{
+}
+
+
+/*
+ * Function:	Diagnostics::~Diagnostics (destructor)
+ *
+ * Description:	Write anything still in the buffer.  The sink of the
+ *		command line's context is a global, so this happens on exit
+ *		no matter how we got there.
+ */
+
+Diagnostics::~Diagnostics()
+{
+    flush();
+}
+
+
+/*
+ * Function:	Diagnostics::format
+ *
+ * Description:	Set the format in which diagnostics are written.
+ */
+
+void Diagnostics::format(Format format)
+{
+    _format = format;
+}
+
+
+/*
+ * Function:	Diagnostics::limit
+ *
+ * Description:	Set the number of diagnostics after which this sink is
+ *		full.  A limit of zero means no limit.
+ */
+
+void Diagnostics::limit(unsigned limit)
+{
+    _limit = limit;
+}
+
+
+/*
+ * Function:	Diagnostics::deduplicate
+ *
+ * Description:	Set whether a diagnostic with the same line and message as
+ *		one already written is dropped.
+ */
+
+void Diagnostics::deduplicate(bool deduplicating)
+{
+    _deduplicating = deduplicating;
+}
+
+
+/*
+ * Function:	Diagnostics::callback
+ *
+ * Description:	Set the callback to which diagnostics are handed instead of
+ *		being written.
+ */
+
+void Diagnostics::callback(DiagnosticCallback callback)
+{
+    _callback = move(callback);
+}
+
+
+/*
+ * Function:	Diagnostics::write (private)
+ *
+ * Description:	Append the given text to the buffer, writing the buffer
+ *		out first if there is not enough room.  Text too large for
+ *		the buffer is written directly.  Empty text, whose data may
+ *		be null, is never copied.
+ */
+
+void Diagnostics::write(string_view s)
+{
+    if (s.empty())
+	return;
+
+    if (_used + s.size() > sizeof(_buffer))
+	flush();
+
+    if (s.size() > sizeof(_buffer))
+	fwrite(s.data(), 1, s.size(), stderr);
+    else {
+	memcpy(_buffer + _used, s.data(), s.size());
+	_used += s.size();
+    }
+}
+
+
+/*
+ * Function:	Diagnostics::escape (private)
+ *
+ * Description:	Append the given text as part of a JSON string, escaping
+ *		quotes, backslashes, and control characters.
+ */
+
+void Diagnostics::escape(string_view s)
+{
+    char buf[8];
+    size_t i, start;
+
+
+    for (i = start = 0; i < s.size(); i ++)
+	if (s[i] == '"' || s[i] == '\\' || (unsigned char) s[i] < 0x20) {
+	    write(s.substr(start, i - start));
+
+	    if (s[i] == '"' || s[i] == '\\') {
+		buf[0] = '\\';
+		buf[1] = s[i];
+		write(string_view(buf, 2));
+	    } else
+		write(string_view(buf, snprintf(buf, sizeof(buf), "\\u%04x",
+		    (unsigned char) s[i])));
+
+	    start = i + 1;
+	}
+
+    write(s.substr(start));
+}
+
+
+/*
+ * Function:	Diagnostics::emit
+ *
+ * Description:	Write the diagnostic with the given code and argument at
+ *		the given offset in the source, or hand it to the callback
+ *		if there is one, and return whether it was written.
+ *		Nothing is written once the sink is full, or if the
+ *		diagnostic is a duplicate and duplicates are dropped.  The
+ *		message is written in pieces around its argument, so
+ *		nothing is allocated unless we are looking for duplicates
+ *		or have a callback.  The column is only computed if it is
+ *		needed.  Messages have always been cut off at a fixed
+ *		length, and still are.
+ */
+
+bool Diagnostics::emit(size_t offset, Error code, string_view arg)
+{
+    string_view format, before, after;
+    size_t percent;
+    unsigned line;
+    char buf[32];
+
+
+    if (full())
+	return false;
+
+    line = lineOf(offset);
+    format = formats[code];
+
+    if ((percent = format.find("%s")) != string_view::npos) {
+	before = format.substr(0, percent);
+	after = format.substr(percent + 2);
+    } else {
+	before = format;
+	arg = after = string_view();
+    }
+
+    arg = arg.substr(0, MAXMESSAGE - before.size());
+    after = after.substr(0, MAXMESSAGE - before.size() - arg.size());
+
+    if (_deduplicating) {
+	string key(buf, snprintf(buf, sizeof(buf), "%u:", line));
+
+	key.append(before).append(arg).append(after);
+
+	if (!_seen.insert(key).second)
+	    return false;
+    }
+
+    if (_callback) {
+	string message(before);
+
+	message.append(arg).append(after);
+	_callback(line, columnOf(offset), message);
+    } else if (_format == JSON) {
+	write(string_view(buf, snprintf(buf, sizeof(buf),
+	    "{\"line\":%u,\"column\":%u,", line, columnOf(offset))));
+	write("\"severity\":\"error\",\"message\":\"");
+	escape(before);
+	escape(arg);
+	escape(after);
+	write("\"}\n");
+    } else {
+	write(string_view(buf, snprintf(buf, sizeof(buf), "line %u: ", line)));
+	write(before);
+	write(arg);
+	write(after);
+	write("\n");
+    }
+
+    _count ++;
+    return true;
+}
+
+
+/*
+ * Function:	Diagnostics::full
+ *
+ * Description:	Return whether this sink has written as many diagnostics
+ *		as its limit allows.
+ */
+
+bool Diagnostics::full() const
+{
+    return _limit > 0 && _count >= _limit;
+}
+
+
+/*
+ * Function:	Diagnostics::count
+ *
+ * Description:	Return the number of diagnostics written.
+ */
+
+unsigned Diagnostics::count() const
+{
+    return _count;
+}
+
+
+/*
+ * Function:	Diagnostics::flush
+ *
+ * Description:	Write out the contents of the buffer.
+ */
+
+void Diagnostics::flush()
+{
+    fwrite(_buffer, 1, _used, stderr);
+    _used = 0;
+}
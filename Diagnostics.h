@@ -0,0 +1,81 @@
+/*
+ * File:	Diagnostics.h
+ *
+ * Description:	This file contains the class definition for the
+ *		diagnostics sink, through which every diagnostic reported
+ *		against the source is written.  Diagnostics are collected
+ *		in a large buffer that is written to the standard error only
+ *		when it fills or the sink is flushed, rather than once per
+ *		diagnostic.
+ *
+ *		A diagnostic is given as a code and an argument, and its
+ *		message is formatted directly into the buffer, only if it
+ *		is written.  By default, each diagnostic is written as plain
+ *		text prefixed with its line number.  A sink may instead write
+ *		each one as a JSON object on a line of its own, may drop
+ *		diagnostics with the same line and message as one already
+ *		written, and may be limited to a number of diagnostics,
+ *		after which it is full and the caller should stop.
+ *
+ *		Rather than being written at all, diagnostics may instead be
+ *		handed one at a time to a callback given their line, column,
+ *		and message, as when the compiler is embedded in a program.
+ *
+ *		A thread checking part of the source out of order, such as
+ *		one function of many being checked at once, may instead
+ *		have its diagnostics deferred to a list of its own, from
+ *		which they are reported later in their proper order.
+ */
+
+# ifndef DIAGNOSTICS_H
+# define DIAGNOSTICS_H
+# include <functional>
+# include <string>
+# include <string_view>
+# include <unordered_set>
+# include <vector>
+# include "errors.h"
+
+struct Diagnostic {
+    size_t offset;
+    Error code;
+    std::string arg;
+};
+
+typedef std::function<void(unsigned line, unsigned column,
+	std::string_view message)> DiagnosticCallback;
+
+class Diagnostics {
+public:
+    enum Format { TEXT, JSON };
+
+private:
+    char _buffer[1 << 16];
+    size_t _used;
+    Format _format;
+    unsigned _limit, _count;
+    bool _deduplicating;
+    std::unordered_set<std::string> _seen;
+    DiagnosticCallback _callback;
+
+    void write(std::string_view s);
+    void escape(std::string_view s);
+
+public:
+    Diagnostics();
+    ~Diagnostics();
+
+    void format(Format format);
+    void limit(unsigned limit);
+    void deduplicate(bool deduplicating);
+    void callback(DiagnosticCallback callback);
+
+    bool emit(size_t offset, Error code, std::string_view arg = {});
+    bool full() const;
+    unsigned count() const;
+    void flush();
+};
+
+extern thread_local std::vector<Diagnostic> *deferred;
+
+# endif /* DIAGNOSTICS_H */
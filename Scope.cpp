@@ -16,6 +16,8 @@
 # include <cassert>
 # include "Scope.h"
 
+enum { THRESHOLD = 16, MULTIPLIER = 2654435761u };
+
 
 /*
  * Function:	Scope::Scope (constructor)
@@ -24,8 +26,49 @@
  */
 
 Scope::Scope(Scope *enclosing)
-    : _enclosing(enclosing)
+    : _enclosing(enclosing),
+      _visible(enclosing != nullptr ? enclosing->_symbols.size() : 0)
+{
+}
+
+
+/*
+ * Function:	Scope::place
+ *
+ * Description:	Enter the symbol at the given position in the list into
+ *		the index, probing linearly from the slot its name hashes
+ *		to.  A slot's position is one more than the symbol's, so
+ *		that an empty slot is zero.
+ */
+
+void Scope::place(size_t position)
+{
+    Name id = _symbols[position]->id();
+    size_t mask = _index.size() - 1;
+    size_t i = (id * MULTIPLIER) & mask;
+
+
+    while (_index[i].position != 0)
+	i = (i + 1) & mask;
+
+    _index[i].id = id;
+    _index[i].position = position + 1;
+}
+
+
+/*
+ * Function:	Scope::rehash
+ *
+ * Description:	Rebuild the index with the given number of slots, which
+ *		must be a power of two.
+ */
+
+void Scope::rehash(size_t capacity)
 {
+    _index.assign(capacity, Slot {0, 0});
+
+    for (size_t i = 0; i < _symbols.size(); i ++)
+	place(i);
 }
 
 
@@ -33,14 +76,62 @@ Scope::Scope(Scope *enclosing)
  * Function:	Scope::insert
  *
  * Description:	Insert the given symbol into this scope.  It had better not
- *		already be inserted, or we fail big time.
+ *		already be inserted, or we fail big time.  Once the scope
+ *		has more than a few symbols, they are indexed, and the
+ *		index is kept no more than half full.
  */
 
 
 void Scope::insert(Symbol *symbol)
 {
-    assert(find(symbol->name()) == nullptr);
+    assert(find(symbol->id()) == nullptr);
     _symbols.push_back(symbol);
+
+    if (!_index.empty()) {
+	if (_symbols.size() * 2 > _index.size())
+	    rehash(_index.size() * 2);
+	else
+	    place(_symbols.size() - 1);
+
+    } else if (_symbols.size() == THRESHOLD)
+	rehash(THRESHOLD * 4);
+}
+
+
+/*
+ * Function:	Scope::find
+ *
+ * Description:	Find and return the symbol with the given name among the
+ *		first COUNT symbols in this scope.  If no such symbol is
+ *		found, return a null pointer.  A name is in a scope at most
+ *		once, so an indexed symbol need only be checked against
+ *		COUNT.
+ */
+
+Symbol *Scope::find(Name id, size_t count) const
+{
+    size_t i, mask;
+
+
+    if (_index.empty()) {
+	for (i = 0; i < count; i ++)
+	    if (id == _symbols[i]->id())
+		return _symbols[i];
+
+	return nullptr;
+    }
+
+    mask = _index.size() - 1;
+
+    i = (id * MULTIPLIER) & mask;
+
+    while (_index[i].position != 0 && _index[i].id != id)
+	i = (i + 1) & mask;
+
+    if (_index[i].position == 0 || _index[i].position > count)
+	return nullptr;
+
+    return _symbols[_index[i].position - 1];
 }
 
 
@@ -51,13 +142,9 @@ void Scope::insert(Symbol *symbol)
  *		scope.  If no such symbol is found, return a null pointer.
  */
 
-Symbol *Scope::find(const string &name) const
+Symbol *Scope::find(Name id) const
 {
-    for (auto symbol : _symbols)
-	if (name == symbol->name())
-	    return symbol;
-
-    return nullptr;
+    return find(id, _symbols.size());
 }
 
 
@@ -66,19 +153,44 @@ Symbol *Scope::find(const string &name) const
  *
  * Description:	Find and return the nearest symbol with the given name,
  *		starting the search in the given scope and moving into the
- *		enclosing scopes.  If no such symbol is found, return a
- *		null pointer.
+ *		enclosing scopes, each of whose symbols are searched only
+ *		as far as are visible from the scope it encloses.  If no
+ *		such symbol is found, return a null pointer.
  */
 
-Symbol *Scope::lookup(const string &name) const
+Symbol *Scope::lookup(Name id) const
 {
+    const Scope *scope;
     Symbol *symbol;
+    size_t count;
+
+
+    count = _symbols.size();
+
+    for (scope = this; scope != nullptr; scope = scope->_enclosing) {
+	symbol = scope->find(id, count);
+
+	if (symbol != nullptr)
+	    return symbol;
 
+	count = scope->_visible;
+    }
 
-    if ((symbol = find(name)) != nullptr)
-	return symbol;
+    return nullptr;
+}
+
+
+/*
+ * Function:	Scope::reveal
+ *
+ * Description:	Make every symbol now in the enclosing scope visible from
+ *		this scope.
+ */
 
-    return _enclosing != nullptr ? _enclosing->lookup(name) : nullptr;
+void Scope::reveal()
+{
+    if (_enclosing != nullptr)
+	_visible = _enclosing->_symbols.size();
 }
 
 
@@ -94,6 +206,19 @@ Scope *Scope::enclosing() const
 }
 
 
+/*
+ * Function:	Scope::visible (accessor)
+ *
+ * Description:	Return the number of symbols in the enclosing scope that
+ *		are visible from this scope.
+ */
+
+size_t Scope::visible() const
+{
+    return _visible;
+}
+
+
 /*
  * Function:	Scope::symbols (accessor)
  *
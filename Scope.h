@@ -5,37 +5,59 @@
  *		Simple C.  A scope consists simply of a list of symbols.
  *		We use a vector rather than a map because we want to keep
  *		the symbols in insertion order, and we expect the number of
- *		symbols inserted to be small.
+ *		symbols inserted to be small.  A scope that grows large,
+ *		such as the outermost scope of a generated header, is also
+ *		given an open-addressing index from names to positions in
+ *		the list, so that it is no longer searched linearly.  The
+ *		index is only ever changed when a symbol is inserted.
  *
  *		Each scope has a link to its enclosing scope.  By
  *		convention, a null scope is used if there is no enclosing
  *		scope.  The find function searches only the given scope,
  *		whereas the lookup function searches the given scope and
- *		all enclosing scopes.
+ *		all enclosing scopes.  Symbols are found by their interned
+ *		names, so each comparison is just an integer comparison.
+ *
+ *		A scope sees only the symbols its enclosing scope had when
+ *		it was opened, or when they were last revealed to it.  The
+ *		enclosing scopes do not otherwise change while a scope is
+ *		open, except for the outermost scope when functions are
+ *		checked in parallel after every declaration has been seen,
+ *		and then each function still sees just what precedes it.
  */
 
 # ifndef SCOPE_H
 # define SCOPE_H
 # include "Symbol.h"
-# include <string>
 # include <vector>
 
 typedef std::vector<Symbol *> Symbols;
 
 class Scope {
-    typedef std::string string;
+    struct Slot {
+	Name id;
+	unsigned position;
+    };
 
     Scope *_enclosing;
+    size_t _visible;
     Symbols _symbols;
+    std::vector<Slot> _index;
+
+    void place(size_t position);
+    void rehash(size_t capacity);
 
 public:
     Scope(Scope *enclosing = nullptr);
 
     void insert(Symbol *symbol);
-    Symbol *find(const string &name) const;
-    Symbol *lookup(const string &name) const;
+    Symbol *find(Name id) const;
+    Symbol *find(Name id, size_t count) const;
+    Symbol *lookup(Name id) const;
+    void reveal();
 
     Scope *enclosing() const;
+    size_t visible() const;
     const Symbols &symbols() const;
 };
 
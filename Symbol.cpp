@@ -17,8 +17,8 @@ using std::string;
  * Description:	Initialize a symbol object.
  */
 
-Symbol::Symbol(const string &name, const Type &type)
-    : _name(name), _type(type)
+Symbol::Symbol(Name id, const Type &type)
+    : _id(id), _type(type)
 {
 }
 
@@ -31,7 +31,19 @@ Symbol::Symbol(const string &name, const Type &type)
 
 const string &Symbol::name() const
 {
-    return _name;
+    return spelling(_id);
+}
+
+
+/*
+ * Function:	Symbol::id (accessor)
+ *
+ * Description:	Return the interned name of this symbol.
+ */
+
+Name Symbol::id() const
+{
+    return _id;
 }
 
 
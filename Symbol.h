@@ -3,22 +3,25 @@
  *
  * Description:	This file contains the class definition for symbols in
  *		Simple C.  At this point, a symbol merely consists of a
- *		name and a type, neither of which you can change.
+ *		name and a type, neither of which you can change.  The name
+ *		is kept interned; its spelling is in the identifier table.
  */
 
 # ifndef SYMBOL_H
 # define SYMBOL_H
 # include <string>
 # include "Type.h"
+# include "intern.h"
 
 class Symbol {
     typedef std::string string;
-    string _name;
+    Name _id;
     Type _type;
 
 public:
-    Symbol(const string &name, const Type &type);
+    Symbol(Name id, const Type &type);
     const string &name() const;
+    Name id() const;
     const Type &type() const;
 };
 
@@ -0,0 +1,615 @@
+/*
+ * File:	TokenBuffer.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the token buffer.
+ */
+
+# include <algorithm>
+# include <cassert>
+# include <cerrno>
+# include <cstdint>
+# include <thread>
+# include "lexer.h"
+# include "scanner.h"
+# include "source.h"
+# include "tokens.h"
+# include "TokenBuffer.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+
+/*
+ * A chunk is one of the pieces of the source scanned on its own thread.
+ * Its tokens are those that start within it when it is scanned from its
+ * beginning, as though a token started there.  That is only a guess,
+ * since the chunk may begin within a token or comment, but the guess
+ * is right from the first point at which the chunk's scan and the true
+ * scan of the source both resume scanning at the same offset.  The
+ * tokens are kept just as in a token buffer, except that names are not
+ * yet interned.
+ */
+
+struct TokenBuffer::Chunk {
+    size_t begin, end;
+    std::vector<short> kinds;
+    std::vector<unsigned> positions, lengths;
+    std::vector<Value> values;
+    std::vector<std::pair<unsigned, Error>> messages;
+    string chars;
+
+    void scan(char *source, size_t size);
+    unsigned resume(size_t offset) const;
+};
+
+
+/*
+ * Function:	TokenBuffer::Chunk::scan
+ *
+ * Description:	Scan and check the tokens that start in this chunk of the
+ *		given source.  The last chunk includes the end of file.
+ */
+
+void TokenBuffer::Chunk::scan(char *source, size_t size)
+{
+    Scanner scanner;
+    Literal literal;
+    Error message;
+    Value value;
+    int kind;
+
+
+    scanner.scanBuffer(source, size);
+    scanner.seek(begin);
+
+    do {
+	kind = scanner.read();
+
+	if (scanner.offset() >= end)
+	    break;
+
+	string_view text(scanner.text(), scanner.length());
+
+	if (!(message = checkLiteral(kind, text, literal)))
+	    message = scanner.message();
+
+	if (message)
+	    messages.push_back(make_pair(kinds.size(), message));
+
+	if (kind == INTEGER || kind == CHARACTER)
+	    value.integer = literal.integer;
+	else if (kind == REAL)
+	    value.real = literal.real;
+	else if (kind == STRING) {
+	    value.chars.offset = chars.size();
+	    value.chars.length = literal.chars.size();
+	    chars += literal.chars;
+	} else
+	    value.integer = 0;
+
+	kinds.push_back(kind);
+	positions.push_back(scanner.offset());
+	lengths.push_back(scanner.length());
+	values.push_back(value);
+    } while (kind != DONE);
+}
+
+
+/*
+ * Function:	TokenBuffer::Chunk::resume
+ *
+ * Description:	Return the index of the token that this chunk's scan read
+ *		after resuming at the given offset, or -1 if its scan never
+ *		resumed there.  The scan resumes at the beginning of the
+ *		chunk and at the end of each token.
+ */
+
+unsigned TokenBuffer::Chunk::resume(size_t offset) const
+{
+    unsigned lo, hi, mid;
+
+
+    if (offset == begin)
+	return 0;
+
+    lo = 0;
+    hi = kinds.size();
+
+    while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+
+	if (positions[mid] + lengths[mid] < offset)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+
+    if (lo < kinds.size() && positions[lo] + lengths[lo] == offset)
+	return lo + 1;
+
+    return -1;
+}
+
+
+/*
+ * Function:	TokenBuffer::TokenBuffer (constructor)
+ *
+ * Description:	Initialize this token buffer.  If the source is not mapped
+ *		then the offsets will refer to our own text buffer.
+ */
+
+TokenBuffer::TokenBuffer()
+    : _source(nullptr), _origin(0)
+{
+}
+
+
+/*
+ * Function:	TokenBuffer::pipeline
+ *
+ * Description:	Start the lexer running ahead on a thread of its own, and
+ *		read all further tokens from it through a queue.
+ */
+
+void TokenBuffer::pipeline()
+{
+    assert(_queue == nullptr && !done());
+    _queue.reset(new TokenQueue());
+}
+
+
+/*
+ * Function:	TokenBuffer::stop
+ *
+ * Description:	Stop the lexer if it is running ahead.
+ */
+
+void TokenBuffer::stop()
+{
+    if (_queue != nullptr)
+	_queue->stop();
+}
+
+
+/*
+ * Function:	TokenBuffer::read
+ *
+ * Description:	Read the next token, either from the lexer or from the
+ *		queue if pipelined, and append it to this buffer.
+ */
+
+void TokenBuffer::read()
+{
+    int kind;
+
+
+    assert(!done());
+
+    if (_queue != nullptr) {
+	const TokenQueue::Token &t = _queue->front();
+	append(t.kind, t.position, t.text, t.message, t.value);
+	_queue->pop();
+    } else {
+	lexerror = NO_ERROR;
+	kind = yylex();
+	append(kind, yyoffset, string_view(yytext, yyleng), lexerror, yylval);
+    }
+}
+
+
+/*
+ * Function:	TokenBuffer::append (private)
+ *
+ * Description:	Append the given token to this buffer, along with any
+ *		diagnostic the lexer issued for it.  The source spanned by
+ *		the tokens in the buffer may not grow past the limit, and
+ *		a token that would take it past is taken as the end of file.
+ */
+
+void TokenBuffer::append(int kind, size_t position, string_view text,
+	Error message, const Literal &literal)
+{
+    Value value;
+
+
+    if (position - _origin + text.size() > SOURCE_LIMIT) {
+	fatal(EFBIG);
+	kind = DONE;
+	position = _origin;
+	text = string_view();
+    }
+
+    _positions.push_back(position - _origin);
+
+    if (context->source != nullptr) {
+	_source = context->source;
+	_offsets.push_back(position);
+    } else {
+	_offsets.push_back(_text.size());
+	_text.append(text);
+    }
+
+    if (message)
+	_messages.push_back(make_pair(_kinds.size(), message));
+
+    if (kind == ID)
+	value.name = intern(text);
+    else if (kind == INTEGER || kind == CHARACTER)
+	value.integer = literal.integer;
+    else if (kind == REAL)
+	value.real = literal.real;
+    else if (kind == STRING) {
+	value.chars.offset = _chars.size();
+	value.chars.length = literal.chars.size();
+	_chars += literal.chars;
+    } else
+	value.integer = 0;
+
+    _kinds.push_back(kind);
+    _lengths.push_back(kind != DONE ? text.size() : 0);
+    _values.push_back(value);
+}
+
+
+/*
+ * Function:	TokenBuffer::readAll
+ *
+ * Description:	Read all remaining tokens up to and including the end of
+ *		file.
+ */
+
+void TokenBuffer::readAll()
+{
+    while (!done())
+	read();
+}
+
+
+/*
+ * Function:	TokenBuffer::take (private)
+ *
+ * Description:	Append the tokens of the given chunk from the given index
+ *		on, which are known to be exactly what the lexer would have
+ *		read.  Everything but the names is copied in bulk.
+ */
+
+void TokenBuffer::take(const Chunk &chunk, unsigned from)
+{
+    unsigned base, n, i;
+    size_t chars;
+    Value value;
+
+
+    base = _kinds.size();
+    n = chunk.kinds.size();
+    chars = _chars.size();
+    _source = context->source;
+
+    _kinds.insert(_kinds.end(), chunk.kinds.begin() + from, chunk.kinds.end());
+    _positions.insert(_positions.end(), chunk.positions.begin() + from,
+	chunk.positions.end());
+    _offsets.insert(_offsets.end(), chunk.positions.begin() + from,
+	chunk.positions.end());
+    _lengths.insert(_lengths.end(), chunk.lengths.begin() + from,
+	chunk.lengths.end());
+    _chars += chunk.chars;
+
+    for (i = from; i < n; i ++) {
+	value = chunk.values[i];
+
+	if (chunk.kinds[i] == ID)
+	    value.name = intern(string_view(_source + chunk.positions[i],
+		chunk.lengths[i]));
+	else if (chunk.kinds[i] == STRING)
+	    value.chars.offset += chars;
+
+	_values.push_back(value);
+    }
+
+    for (auto &m : chunk.messages)
+	if (m.first >= from)
+	    _messages.push_back(make_pair(base + m.first - from, m.second));
+}
+
+
+/*
+ * Function:	TokenBuffer::readAll
+ *
+ * Description:	Read all of the tokens in the mapped source, dividing it
+ *		evenly into chunks that are scanned on the given number of
+ *		threads, and then joining their tokens.  Joining starts at
+ *		the beginning of the source.  If the chunk at the current
+ *		offset resumed scanning there, we take its tokens from that
+ *		point on and move to the next chunk.  Otherwise, we scan the
+ *		next token ourselves and try again after it.  The result is
+ *		exactly what the lexer would have read.  With one thread,
+ *		the whole source is simply scanned as one chunk, without
+ *		using the lexer, so that any number of sources may be read
+ *		at once.
+ */
+
+void TokenBuffer::readAll(unsigned threads)
+{
+    vector<Chunk> chunks(threads);
+    vector<thread> workers;
+    unsigned c, i, k;
+    Scanner scanner;
+    Literal literal;
+    Error message;
+    size_t offset, total, size;
+    char *source;
+    int kind;
+
+
+    source = context->source;
+    size = context->sourcesize;
+    assert(source != nullptr && threads > 0 && _kinds.empty());
+
+    for (i = 0; i < threads; i ++) {
+	chunks[i].begin = size * i / threads;
+	chunks[i].end = size * (i + 1) / threads;
+    }
+
+    chunks[threads - 1].end = SIZE_MAX;
+
+    for (i = 1; i < threads; i ++)
+	workers.emplace_back(&Chunk::scan, &chunks[i], source, size);
+
+    chunks[0].scan(source, size);
+
+    for (auto &worker : workers)
+	worker.join();
+
+    total = 0;
+
+    for (auto &chunk : chunks)
+	total += chunk.kinds.size();
+
+    _kinds.reserve(total);
+    _positions.reserve(total);
+    _offsets.reserve(total);
+    _lengths.reserve(total);
+    _values.reserve(total);
+
+    scanner.scanBuffer(source, size);
+    offset = 0;
+    c = 0;
+
+    while (1) {
+	if ((k = chunks[c].resume(offset)) != (unsigned) -1) {
+	    take(chunks[c], k);
+
+	    if (k < chunks[c].kinds.size())
+		offset = _positions.back() + _lengths.back();
+
+	    if (++ c == threads)
+		break;
+
+	    continue;
+	}
+
+	scanner.seek(offset);
+	kind = scanner.read();
+
+	string_view text(scanner.text(), scanner.length());
+
+	if (!(message = checkLiteral(kind, text, literal)))
+	    message = scanner.message();
+
+	append(kind, scanner.offset(), text, message, literal);
+
+	if (kind == DONE)
+	    break;
+
+	offset = scanner.offset() + scanner.length();
+
+	while (c + 1 < threads && scanner.offset() >= chunks[c + 1].begin)
+	    c ++;
+    }
+}
+
+
+/*
+ * Function:	TokenBuffer::done
+ *
+ * Description:	Return whether the end of file has been read.
+ */
+
+bool TokenBuffer::done() const
+{
+    return !_kinds.empty() && _kinds.back() == DONE;
+}
+
+
+/*
+ * Function:	TokenBuffer::discard
+ *
+ * Description:	Discard every token before the given one, which must have
+ *		been read, so that it becomes the first.  The tokens kept
+ *		are moved to the front of each array, along with their text
+ *		if it is ours and the contents of their strings, and their
+ *		positions are made relative to the first of them.  Few
+ *		tokens are ever read ahead, so few are moved.
+ */
+
+void TokenBuffer::discard(unsigned first)
+{
+    size_t text, chars, origin;
+    unsigned i;
+
+
+    assert(first < size());
+
+    if (first == 0)
+	return;
+
+    origin = _positions[first];
+    text = _source == nullptr ? _offsets[first] : 0;
+    chars = _chars.size();
+
+    for (i = first; i < _kinds.size(); i ++)
+	if (_kinds[i] == STRING) {
+	    chars = _values[i].chars.offset;
+	    break;
+	}
+
+    _kinds.erase(_kinds.begin(), _kinds.begin() + first);
+    _positions.erase(_positions.begin(), _positions.begin() + first);
+    _offsets.erase(_offsets.begin(), _offsets.begin() + first);
+    _lengths.erase(_lengths.begin(), _lengths.begin() + first);
+    _values.erase(_values.begin(), _values.begin() + first);
+    _text.erase(0, text);
+    _chars.erase(0, chars);
+
+    for (i = 0; i < _kinds.size(); i ++) {
+	_positions[i] -= origin;
+	_offsets[i] -= text;
+
+	if (_kinds[i] == STRING)
+	    _values[i].chars.offset -= chars;
+    }
+
+    _messages.erase(_messages.begin(), lower_bound(_messages.begin(),
+	_messages.end(), make_pair(first, NO_ERROR)));
+
+    for (auto &m : _messages)
+	m.first -= first;
+
+    _origin += origin;
+}
+
+
+/*
+ * Function:	TokenBuffer::size (accessor)
+ *
+ * Description:	Return the number of tokens read so far.
+ */
+
+unsigned TokenBuffer::size() const
+{
+    return _kinds.size();
+}
+
+
+/*
+ * Function:	TokenBuffer::kind (accessor)
+ *
+ * Description:	Return the kind of the given token.
+ */
+
+int TokenBuffer::kind(unsigned i) const
+{
+    return _kinds[i];
+}
+
+
+/*
+ * Function:	TokenBuffer::text (accessor)
+ *
+ * Description:	Return the text of the given token.  The view is into
+ *		the source if it is mapped.  Otherwise, it is into our own
+ *		text buffer and is valid only until the next token is read.
+ */
+
+string_view TokenBuffer::text(unsigned i) const
+{
+    const char *base = _source != nullptr ? _source : _text.data();
+    return string_view(base + _offsets[i], _lengths[i]);
+}
+
+
+/*
+ * Function:	TokenBuffer::position (accessor)
+ *
+ * Description:	Return the offset of the given token in the source.
+ */
+
+size_t TokenBuffer::position(unsigned i) const
+{
+    return _origin + _positions[i];
+}
+
+
+/*
+ * Function:	TokenBuffer::line (accessor)
+ *
+ * Description:	Return the line on which the given token was read.
+ */
+
+unsigned TokenBuffer::line(unsigned i) const
+{
+    return lineOf(position(i));
+}
+
+
+/*
+ * Function:	TokenBuffer::name (accessor)
+ *
+ * Description:	Return the name of the given identifier token.
+ */
+
+Name TokenBuffer::name(unsigned i) const
+{
+    assert(_kinds[i] == ID);
+    return _values[i].name;
+}
+
+
+/*
+ * Function:	TokenBuffer::integer (accessor)
+ *
+ * Description:	Return the value of the given integer or character
+ *		literal.
+ */
+
+unsigned long TokenBuffer::integer(unsigned i) const
+{
+    assert(_kinds[i] == INTEGER || _kinds[i] == CHARACTER);
+    return _values[i].integer;
+}
+
+
+/*
+ * Function:	TokenBuffer::real (accessor)
+ *
+ * Description:	Return the value of the given floating-point literal.
+ */
+
+double TokenBuffer::real(unsigned i) const
+{
+    assert(_kinds[i] == REAL);
+    return _values[i].real;
+}
+
+
+/*
+ * Function:	TokenBuffer::chars (accessor)
+ *
+ * Description:	Return the decoded contents of the given string literal,
+ *		which like its text are valid only until the next token is
+ *		read.
+ */
+
+string_view TokenBuffer::chars(unsigned i) const
+{
+    assert(_kinds[i] == STRING);
+    return string_view(_chars.data() + _values[i].chars.offset,
+	_values[i].chars.length);
+}
+
+
+/*
+ * Function:	TokenBuffer::message (accessor)
+ *
+ * Description:	Return the diagnostic issued by the lexer for the given
+ *		token, or no error if there was none.
+ */
+
+Error TokenBuffer::message(unsigned i) const
+{
+    auto it = lower_bound(_messages.begin(), _messages.end(),
+	make_pair(i, NO_ERROR));
+
+    return it != _messages.end() && it->first == i ? it->second : NO_ERROR;
+}
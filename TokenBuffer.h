@@ -0,0 +1,112 @@
+/*
+ * File:	TokenBuffer.h
+ *
+ * Description:	This file contains the class definition for the token
+ *		buffer, which holds the tokens produced by the lexer as a
+ *		structure of arrays: the kind, position, text offset, and
+ *		length of each token are kept in separate contiguous vectors
+ *		and a token is referred to simply by its index.  The parser
+ *		walks the indices, so lookahead is arbitrary and the tokens
+ *		can be walked again cheaply by later phases.
+ *
+ *		The position of a token is its offset in the source, from
+ *		which its line is found only when asked for.  If the source
+ *		has been mapped into memory, the text offsets are the same
+ *		as the positions, and the text of a token is a view into the
+ *		source with nothing copied.  Otherwise, the source is being
+ *		streamed and the text of each token is appended to a single
+ *		buffer owned by the token buffer, which the text offsets
+ *		then refer to instead.
+ *
+ *		Any diagnostic issued by the lexer for a token is recorded
+ *		with the token rather than reported immediately, so that
+ *		the parser can report it when it reaches the token, which
+ *		is exactly when it would have been reported had the token
+ *		been lexed on demand.
+ *
+ *		Tokens are normally read by calling the lexer directly.  If
+ *		the buffer is pipelined, the lexer instead runs ahead on a
+ *		thread of its own and the tokens are taken from a queue.
+ *		Either way, they are appended in the same order with the
+ *		same diagnostics.  A mapped source may also be read all at
+ *		once by scanning pieces of it on several threads.
+ *
+ *		Each token also has a value.  Identifiers are interned as
+ *		they are read, so the name of an identifier is available
+ *		without touching its text.  Literals keep the value computed
+ *		by the lexer when it checked them, and the decoded contents
+ *		of string literals are kept together in one buffer.
+ *
+ *		When a long source is streamed, the tokens before a given
+ *		one may be discarded once they will never be looked at
+ *		again, along with their text.  The tokens kept are then
+ *		numbered from zero, and their positions are kept relative
+ *		to the position of the first of them, so that neither is
+ *		limited by how much of the source has been read.  Only the
+ *		source spanned by the tokens kept is limited, as it is for
+ *		a source that is not streamed.
+ */
+
+# ifndef TOKENBUFFER_H
+# define TOKENBUFFER_H
+# include <memory>
+# include <string>
+# include <string_view>
+# include <utility>
+# include <vector>
+# include "intern.h"
+# include "lexer.h"
+# include "TokenQueue.h"
+
+class TokenBuffer {
+    typedef std::string string;
+    typedef std::string_view string_view;
+
+    union Value {
+	Name name;
+	unsigned long integer;
+	double real;
+	struct {
+	    unsigned offset, length;
+	} chars;
+    };
+
+    std::vector<short> _kinds;
+    std::vector<unsigned> _positions, _offsets, _lengths;
+    std::vector<Value> _values;
+    std::vector<std::pair<unsigned, Error>> _messages;
+    const char *_source;
+    string _text, _chars;
+    size_t _origin;
+    std::unique_ptr<TokenQueue> _queue;
+
+    struct Chunk;
+
+    void append(int kind, size_t position, string_view text,
+	Error message, const Literal &literal);
+    void take(const Chunk &chunk, unsigned from);
+
+public:
+    TokenBuffer();
+
+    void pipeline();
+    void stop();
+    void read();
+    void readAll();
+    void readAll(unsigned threads);
+    bool done() const;
+    void discard(unsigned first);
+
+    unsigned size() const;
+    int kind(unsigned i) const;
+    string_view text(unsigned i) const;
+    size_t position(unsigned i) const;
+    unsigned line(unsigned i) const;
+    Name name(unsigned i) const;
+    unsigned long integer(unsigned i) const;
+    double real(unsigned i) const;
+    string_view chars(unsigned i) const;
+    Error message(unsigned i) const;
+};
+
+# endif /* TOKENBUFFER_H */
@@ -0,0 +1,201 @@
+/*
+ * File:	TokenQueue.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the token queue.
+ */
+
+# include <cassert>
+# include "lexer.h"
+# include "source.h"
+# include "tokens.h"
+# include "TokenQueue.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+enum { SPINS = 64 };
+
+
+/*
+ * Function:	backoff
+ *
+ * Description:	Wait a little while for the other side of the queue.  We
+ *		spin briefly at first, since the other side is usually just
+ *		about to catch up, and then give up the processor.
+ */
+
+static void backoff(unsigned &spins)
+{
+    if (++ spins < SPINS)
+	return;
+
+    this_thread::yield();
+}
+
+
+/*
+ * Function:	TokenQueue::TokenQueue (constructor)
+ *
+ * Description:	Initialize this queue with the given number of slots and
+ *		start reading tokens into it from the current context.
+ */
+
+TokenQueue::TokenQueue(size_t capacity)
+    : _slots(capacity), _head(0), _filled(0), _tail(0), _emptied(0),
+      _stopped(false), _finished(false), _context(context)
+{
+    assert(capacity > 0);
+    _thread = thread(&TokenQueue::produce, this);
+}
+
+
+/*
+ * Function:	TokenQueue::~TokenQueue (destructor)
+ *
+ * Description:	Stop reading tokens and wait for the producer to finish.
+ */
+
+TokenQueue::~TokenQueue()
+{
+    stop();
+}
+
+
+/*
+ * Function:	TokenQueue::produce (private)
+ *
+ * Description:	Read tokens into the queue on the producer's thread, and
+ *		then, however we stopped, leave the end of file for the
+ *		consumer and say that we have finished.
+ */
+
+void TokenQueue::produce()
+{
+    context = _context;
+    fill();
+
+    _end.kind = DONE;
+    _end.position = yyoffset;
+    _end.message = NO_ERROR;
+    _finished.store(true, memory_order_release);
+}
+
+
+/*
+ * Function:	TokenQueue::fill (private)
+ *
+ * Description:	Read tokens into the queue until the end of file is read
+ *		or the queue is stopped.  A token's text is referred to in
+ *		place if the source is mapped, and copied otherwise, since
+ *		the lexer may then reuse its buffer.
+ *
+ *		The lexer is usually faster than the parser, so the queue is
+ *		usually full.  Once it is, we wait until it is half empty
+ *		before reading again, rather than filling each slot as soon
+ *		as it is freed and fighting the parser over the indices.
+ */
+
+void TokenQueue::fill()
+{
+    size_t tail = 0;
+    unsigned spins;
+    int kind;
+
+
+    do {
+	if (tail - _emptied == _slots.size())
+	    for (spins = 0; tail - _emptied > _slots.size() / 2; backoff(spins)) {
+		if (_stopped.load(memory_order_relaxed))
+		    return;
+
+		_emptied = _head.load(memory_order_acquire);
+	    }
+
+	Token &t = _slots[tail % _slots.size()];
+
+	lexerror = NO_ERROR;
+	t.kind = kind = yylex();
+	t.position = yyoffset;
+	t.message = lexerror;
+
+	if (kind == INTEGER || kind == CHARACTER)
+	    t.value.integer = yylval.integer;
+	else if (kind == REAL)
+	    t.value.real = yylval.real;
+	else if (kind == STRING)
+	    t.value.chars = yylval.chars;
+
+	if (context->source != nullptr)
+	    t.text = string_view(yytext, yyleng);
+	else {
+	    t.copy.assign(yytext, yyleng);
+	    t.text = t.copy;
+	}
+
+	_tail.store(++ tail, memory_order_release);
+    } while (kind != DONE && !_stopped.load(memory_order_relaxed));
+}
+
+
+/*
+ * Function:	TokenQueue::front
+ *
+ * Description:	Return the next token in the queue, waiting for the
+ *		producer to read it if necessary.  Once the producer has
+ *		finished and the queue is empty, the next token is always
+ *		the end of file.
+ */
+
+const TokenQueue::Token &TokenQueue::front()
+{
+    size_t head = _head.load(memory_order_relaxed);
+    unsigned spins;
+
+
+    for (spins = 0; head == _filled; backoff(spins)) {
+	if (_finished.load(memory_order_acquire)) {
+	    _filled = _tail.load(memory_order_acquire);
+	    return head == _filled ? _end : _slots[head % _slots.size()];
+	}
+
+	_filled = _tail.load(memory_order_acquire);
+    }
+
+    return _slots[head % _slots.size()];
+}
+
+
+/*
+ * Function:	TokenQueue::pop
+ *
+ * Description:	Remove the next token from the queue, giving its slot
+ *		back to the producer.  The end of file left once the
+ *		producer has finished is never removed.
+ */
+
+void TokenQueue::pop()
+{
+    size_t head = _head.load(memory_order_relaxed);
+
+
+    if (head != _filled)
+	_head.store(head + 1, memory_order_release);
+}
+
+
+/*
+ * Function:	TokenQueue::stop
+ *
+ * Description:	Stop reading tokens and wait for the producer to finish.
+ *		The producer stops after the token it is reading, so this
+ *		must be done before exiting while it may still be running.
+ */
+
+void TokenQueue::stop()
+{
+    _stopped.store(true, memory_order_relaxed);
+
+    if (_thread.joinable())
+	_thread.join();
+}
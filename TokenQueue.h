@@ -0,0 +1,71 @@
+/*
+ * File:	TokenQueue.h
+ *
+ * Description:	This file contains the class definition for the token
+ *		queue, which runs the lexer on a thread of its own and hands
+ *		the tokens it reads to the parser through a bounded ring.
+ *		There is exactly one producer and one consumer, so the ring
+ *		needs no locks: each side owns one index into it and
+ *		publishes the index to the other side with a release store.
+ *		Each side also keeps a copy of the other's index and only
+ *		reloads it when the ring looks full or empty, so that the
+ *		indices are not passed back and forth for every token.
+ *
+ *		Only the producer ever calls the lexer, and only the
+ *		consumer interns names or reports diagnostics.  The producer
+ *		reads the source of the context that created the queue.  The slots
+ *		are reused, so copying the text or value of a token into a
+ *		slot allocates only until its strings are large enough.
+ *
+ *		However the producer finishes, whether at the end of file or
+ *		because it was stopped, it leaves an end of file token
+ *		outside the ring and then says that it has finished, so the
+ *		consumer never waits for a token that will not come.
+ */
+
+# ifndef TOKENQUEUE_H
+# define TOKENQUEUE_H
+# include <atomic>
+# include <string>
+# include <string_view>
+# include <thread>
+# include <vector>
+# include "lexer.h"
+
+struct CompilerContext;
+
+class TokenQueue {
+public:
+    struct Token {
+	int kind;
+	size_t position;
+	std::string_view text;
+	Error message;
+	Literal value;
+	std::string copy;
+    };
+
+private:
+    std::vector<Token> _slots;
+    alignas(64) std::atomic<size_t> _head;
+    size_t _filled;
+    alignas(64) std::atomic<size_t> _tail;
+    size_t _emptied;
+    alignas(64) std::atomic<bool> _stopped, _finished;
+    Token _end;
+    CompilerContext *_context;
+    std::thread _thread;
+
+    void produce();
+    void fill();
+
+public:
+    TokenQueue(size_t capacity = 1024);
+    ~TokenQueue();
+
+    const Token &front();
+    void pop();
+    void stop();
+};
+
+# endif /* TOKENQUEUE_H */
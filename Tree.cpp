@@ -0,0 +1,267 @@
+/*
+ * File:	Tree.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		abstract syntax trees in Simple C.
+ */
+
+# include <cassert>
+# include "Tree.h"
+
+using namespace std;
+
+
+/*
+ * Function:	Tree::Tree (constructor)
+ *
+ * Description:	Initialize this tree to be empty.
+ */
+
+Tree::Tree()
+{
+    clear();
+}
+
+
+/*
+ * Function:	Tree::at (private)
+ *
+ * Description:	Return the entry for the given node.
+ */
+
+Tree::Entry &Tree::at(Node n)
+{
+    assert(n > 0 && n < _size);
+    return _blocks[n / BLOCK][n % BLOCK];
+}
+
+const Tree::Entry &Tree::at(Node n) const
+{
+    assert(n > 0 && n < _size);
+    return _blocks[n / BLOCK][n % BLOCK];
+}
+
+
+/*
+ * Function:	Tree::add
+ *
+ * Description:	Add a node to the tree with the given children, which are
+ *		a list linked through their siblings, and return its index.
+ */
+
+Node Tree::add(int kind, unsigned token, const Type &type, bool lvalue,
+	Node first)
+{
+    if (_size / BLOCK == _blocks.size())
+	_blocks.emplace_back(new Entry[BLOCK]);
+
+    Entry &e = _blocks[_size / BLOCK][_size % BLOCK];
+
+    e.kind = kind;
+    e.lvalue = lvalue;
+    e.token = token;
+    e.first = first;
+    e.next = 0;
+    e.type = type;
+    e.constant = 0;
+    return _size ++;
+}
+
+
+/*
+ * Function:	Tree::link
+ *
+ * Description:	Make the second node the next sibling of the first.
+ */
+
+void Tree::link(Node node, Node next)
+{
+    at(node).next = next;
+}
+
+
+/*
+ * Function:	Tree::fold
+ *
+ * Description:	Give the given node a constant value.
+ */
+
+void Tree::fold(Node node, Constant value)
+{
+    at(node).constant = _constants.size();
+    _constants.push_back(value);
+}
+
+
+/*
+ * Function:	Tree::clear
+ *
+ * Description:	Release every node in the tree.  The first block is
+ *		kept, so that a tree cleared after each function does not
+ *		allocate again for each.  The zero index is reserved so
+ *		that it can mean no node.
+ */
+
+void Tree::clear()
+{
+    if (_blocks.size() > 1)
+	_blocks.resize(1);
+
+    _size = 0;
+    add(0, 0);
+
+    _constants.resize(1);
+}
+
+
+/*
+ * Function:	Tree::graft
+ *
+ * Description:	Copy every node of another tree to the end of this one,
+ *		along with their constants, and return the new index of
+ *		the given node of the other.
+ */
+
+Node Tree::graft(const Tree &other, Node node)
+{
+    Node offset, n, m;
+
+
+    offset = _size - 1;
+
+    for (n = 1; n < other._size; n ++) {
+	const Entry &e = other.at(n);
+	m = add(e.kind, e.token, e.type, e.lvalue,
+	    e.first != 0 ? e.first + offset : 0);
+	at(m).next = e.next != 0 ? e.next + offset : 0;
+
+	if (e.constant != 0)
+	    fold(m, other._constants[e.constant]);
+    }
+
+    return node + offset;
+}
+
+
+/*
+ * Function:	Tree::size (accessor)
+ *
+ * Description:	Return the number of nodes in the tree.
+ */
+
+unsigned Tree::size() const
+{
+    return _size;
+}
+
+
+/*
+ * Function:	Tree::bytes (accessor)
+ *
+ * Description:	Return the number of bytes allocated for the nodes and
+ *		their constants.
+ */
+
+size_t Tree::bytes() const
+{
+    return _blocks.size() * BLOCK * sizeof(Entry)
+	+ _constants.capacity() * sizeof(Constant);
+}
+
+
+/*
+ * Function:	Tree::kind (accessor)
+ *
+ * Description:	Return the kind of the given node.
+ */
+
+int Tree::kind(Node n) const
+{
+    return at(n).kind;
+}
+
+
+/*
+ * Function:	Tree::token (accessor)
+ *
+ * Description:	Return the index of the token at which the given node was
+ *		parsed.
+ */
+
+unsigned Tree::token(Node n) const
+{
+    return at(n).token;
+}
+
+
+/*
+ * Function:	Tree::type (accessor)
+ *
+ * Description:	Return the type computed for the given node.
+ */
+
+const Type &Tree::type(Node n) const
+{
+    return at(n).type;
+}
+
+
+/*
+ * Function:	Tree::lvalue (accessor)
+ *
+ * Description:	Return whether the given node is an lvalue.
+ */
+
+bool Tree::lvalue(Node n) const
+{
+    return at(n).lvalue;
+}
+
+
+/*
+ * Function:	Tree::first (accessor)
+ *
+ * Description:	Return the first child of the given node.
+ */
+
+Node Tree::first(Node n) const
+{
+    return at(n).first;
+}
+
+
+/*
+ * Function:	Tree::next (accessor)
+ *
+ * Description:	Return the next sibling of the given node.
+ */
+
+Node Tree::next(Node n) const
+{
+    return at(n).next;
+}
+
+
+/*
+ * Function:	Tree::constant (accessor)
+ *
+ * Description:	Return whether the given node has a constant value.
+ */
+
+bool Tree::constant(Node n) const
+{
+    return at(n).constant != 0;
+}
+
+
+/*
+ * Function:	Tree::value (accessor)
+ *
+ * Description:	Return the constant value of the given node.
+ */
+
+Constant Tree::value(Node n) const
+{
+    assert(at(n).constant != 0);
+    return _constants[at(n).constant];
+}
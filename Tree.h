@@ -0,0 +1,91 @@
+/*
+ * File:	Tree.h
+ *
+ * Description:	This file contains the class definition for abstract
+ *		syntax trees in Simple C.  The parser builds the tree as it
+ *		checks, so each node carries the type computed for it and
+ *		whether it is an lvalue, along with the index of the token
+ *		at which it was parsed.
+ *
+ *		All of the nodes of a translation unit live in a single
+ *		arena, and a node is known by its 32-bit index there rather
+ *		than by a pointer.  The children of a node are kept as a
+ *		list: each node has the index of its first child and of its
+ *		next sibling, and the zero index means no node.  The arena
+ *		is a list of fixed-size blocks, so adding a node never moves
+ *		the others, and the whole tree is released at once when the
+ *		arena is cleared or destroyed.
+ *
+ *		The kind of a node is the token of a binary operator, an
+ *		assignment, a literal, an identifier, or a statement, and
+ *		one of the kinds below for everything else.  A compound
+ *		statement is a left brace.
+ *
+ *		A node whose value is known at compile time also has a
+ *		constant, which is an integer or a double according to the
+ *		type of the node.  Few nodes are constant, so the constants
+ *		are kept in a list of their own, and a node has just the
+ *		index of its constant there, with zero meaning none.
+ */
+
+# ifndef TREE_H
+# define TREE_H
+# include <memory>
+# include <vector>
+# include "Type.h"
+
+typedef unsigned Node;
+
+enum {
+    NEGATE = 512, LOGICAL_NOT, ADDRESS_OF, DEREF, SIZE_OF, CAST, INDEX,
+    CALL, POSTINC, POSTDEC, FUNCTION, UNIT
+};
+
+union Constant {
+    int integer;
+    double real;
+};
+
+class Tree {
+    struct Entry {
+	short kind;
+	bool lvalue;
+	unsigned token;
+	Node first, next;
+	Type type;
+	unsigned constant;
+    };
+
+    enum { BLOCK = 4096 };
+
+    std::vector<std::unique_ptr<Entry[]>> _blocks;
+    unsigned _size;
+    std::vector<Constant> _constants;
+
+    Entry &at(Node n);
+    const Entry &at(Node n) const;
+
+public:
+    Tree();
+
+    Node add(int kind, unsigned token, const Type &type = Type(),
+	bool lvalue = false, Node first = 0);
+    void link(Node node, Node next);
+    void fold(Node node, Constant value);
+    void clear();
+    Node graft(const Tree &other, Node node);
+
+    unsigned size() const;
+    size_t bytes() const;
+
+    int kind(Node n) const;
+    unsigned token(Node n) const;
+    const Type &type(Node n) const;
+    bool lvalue(Node n) const;
+    Node first(Node n) const;
+    Node next(Node n) const;
+    bool constant(Node n) const;
+    Constant value(Node n) const;
+};
+
+# endif /* TREE_H */
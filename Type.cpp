@@ -17,15 +17,122 @@
  *		- predicate functions such as isArray()
  *		- stream operator
  *		- the error type
+ *		- the type table
  */
 
 # include <iostream>
 # include <cassert>
 # include "tokens.h"
+# include "trace.h"
 # include "Type.h"
+# include "CompilerContext.h"
 
 using namespace std;
 
+enum { SHIFT = 6, FIRST = 1 << SHIFT };
+
+const DataLayout LP64 = {1, 4, 8, 8};
+const DataLayout ILP32 = {1, 4, 8, 4};
+
+
+/*
+ * Function:	Type::code (private)
+ *
+ * Description:	Return the code for the given specifier: zero for char,
+ *		one for int, two for double, and three for anything else.
+ */
+
+unsigned Type::code(int specifier)
+{
+    if (specifier == CHAR)
+	return 0;
+
+    if (specifier == INT)
+	return 1;
+
+    if (specifier == DOUBLE)
+	return 2;
+
+    return 3;
+}
+
+
+/*
+ * Function:	Type::preset (private)
+ *
+ * Description:	Return the index at which the scalar type with the given
+ *		specifier and indirection is always found in the table, or
+ *		zero if it must be looked up.
+ */
+
+unsigned Type::preset(int specifier, unsigned indirection)
+{
+    unsigned kind = code(specifier);
+
+
+    if (indirection >= PRESET || kind == 3)
+	return 0;
+
+    return 1 + kind * PRESET + indirection;
+}
+
+
+/*
+ * Function:	Type::pack (private)
+ *
+ * Description:	Return the bits of the type with the given index and
+ *		entry: the index itself, the declarator, the code for the
+ *		specifier, and the properties of the type, which are those
+ *		of its promoted form.
+ *		Promoting a character gives an integer, and promoting an
+ *		array gives a pointer to its element type.
+ */
+
+uint32_t Type::pack(unsigned index, const TypeEntry &entry)
+{
+    unsigned indirection = entry.indirection;
+    int specifier = entry.specifier;
+    bool scalar = entry.declarator == SCALAR;
+    uint32_t bits;
+
+
+    assert(index <= INDEX);
+    bits = index | (uint32_t) entry.declarator << 23;
+    bits |= code(entry.specifier) << 25;
+
+    if (scalar && specifier == CHAR && indirection == 0) {
+	specifier = INT;
+	bits |= PROMOTES;
+    } else if (entry.declarator == ARRAY) {
+	indirection ++;
+	scalar = true;
+	bits |= PROMOTES;
+    }
+
+    if (scalar && indirection == 0 && specifier == INT)
+	bits |= INTEGRAL | NUMERIC;
+
+    if (scalar && indirection == 0 && specifier == DOUBLE)
+	bits |= REAL | NUMERIC;
+
+    if (scalar && indirection > 0)
+	bits |= POINTER;
+
+    return bits;
+}
+
+
+/*
+ * Function:	Type::entry (private)
+ *
+ * Description:	Return the entry for this type in the table.
+ */
+
+const TypeEntry &Type::entry() const
+{
+    return context->types[_bits & INDEX];
+}
+
 
 /*
  * Function:	Type::Type (constructor)
@@ -34,7 +141,19 @@ using namespace std;
  */
 
 Type::Type()
-    : _declarator(ERROR)
+    : _bits((uint32_t) ERROR << 23)
+{
+}
+
+
+/*
+ * Function:	Type::Type (private constructor)
+ *
+ * Description:	Initialize this type object from its bits.
+ */
+
+Type::Type(uint32_t bits)
+    : _bits(bits)
 {
 }
 
@@ -46,70 +165,67 @@ Type::Type()
  */
 
 Type::Type(int specifier, unsigned indirection)
-    : _specifier(specifier), _indirection(indirection)
 {
-    _declarator = SCALAR;
+    TypeEntry entry{SCALAR, (short) specifier, indirection, 0, nullptr, 0};
+    unsigned index = preset(specifier, indirection);
+
+
+    if (index == 0)
+	index = context->types.add(entry);
+
+    _bits = pack(index, entry);
 }
 
 
 /*
  * Function:	Type::Type (constructor)
  *
- * Description:	Initialize this type object as an array type.
+ * Description:	Initialize this type object as an array type.  Its
+ *		promoted form is made first, so that it can be kept with
+ *		it in the table.
  */
 
 Type::Type(int specifier, unsigned indirection, unsigned length)
-    : _specifier(specifier), _indirection(indirection), _length(length)
 {
-    _declarator = ARRAY;
+    TypeEntry entry{ARRAY, (short) specifier, indirection, length, nullptr,
+	Type(specifier, indirection + 1)._bits};
+
+
+    _bits = pack(context->types.add(entry), entry);
 }
 
 
 /*
  * Function:	Type::Type (constructor)
  *
- * Description:	Initialize this type object as a function type.
+ * Description:	Initialize this type object as a function type.  The
+ *		parameter list is copied into the table unless it is
+ *		already there.
  */
 
-Type::Type(int specifier, unsigned indirection, Parameters *parameters)
-    : _specifier(specifier), _indirection(indirection), _parameters(parameters)
+Type::Type(int specifier, unsigned indirection, const Parameters &parameters)
 {
-    _declarator = FUNCTION;
+    TypeTable &types = context->types;
+    TypeEntry entry{FUNCTION, (short) specifier, indirection, 0,
+	types.add(parameters), 0};
+
+
+    _bits = pack(types.add(entry), entry);
 }
 
 
 /*
  * Function:	Type::operator ==
  *
- * Description:	Return whether another type is equal to this type.  The
- *		parameter lists are checked for function types, which C++
- *		makes so easy.  (At least, it makes something easy!)
+ * Description:	Return whether another type is equal to this type.  Each
+ *		type is in the table only once, so equal types have equal
+ *		indices, even function types with their parameter lists,
+ *		and so have equal bits.
  */
 
 bool Type::operator ==(const Type &rhs) const
 {
-    if (_declarator != rhs._declarator)
-	return false;
-
-    if (_declarator == ERROR)
-	return true;
-
-    if (_specifier != rhs._specifier)
-	return false;
-
-    if (_indirection != rhs._indirection)
-	return false;
-
-    if (_declarator == SCALAR)
-	return true;
-
-    if (_declarator == ARRAY)
-	return _length == rhs._length;
-
-    if (_parameters->variadic != rhs._parameters->variadic)
-	return false;
-
-    return _parameters->types == rhs._parameters->types;
+    return _bits == rhs._bits;
 }
 
 
@@ -135,7 +251,7 @@ bool Type::operator !=(const Type &rhs) const
 
 bool Type::isArray() const
 {
-    return _declarator == ARRAY;
+    return (_bits & DECLARATOR) == (uint32_t) ARRAY << 23;
 }
 
 
@@ -147,7 +263,7 @@ bool Type::isArray() const
 
 bool Type::isScalar() const
 {
-    return _declarator == SCALAR;
+    return (_bits & DECLARATOR) == (uint32_t) SCALAR << 23;
 }
 
 
@@ -159,7 +275,7 @@ bool Type::isScalar() const
 
 bool Type::isFunction() const
 {
-    return _declarator == FUNCTION;
+    return (_bits & DECLARATOR) == (uint32_t) FUNCTION << 23;
 }
 
 
@@ -171,17 +287,33 @@ bool Type::isFunction() const
 
 bool Type::isError() const
 {
-    return _declarator == ERROR;
+    return (_bits & INDEX) == 0;
 }
 
+
+/*
+ * Function:	Type::isInteger
+ *
+ * Description:	Return whether this type is an integer type once
+ *		promoted, namely a char or an int.
+ */
+
 bool Type::isInteger() const
 {
-	return((specifier() == INTEGER) && isNumeric() );
+    return _bits & INTEGRAL;
 }
 
+
+/*
+ * Function:	Type::isDouble
+ *
+ * Description:	Return whether this type is a double once promoted.
+ *		Pointers to doubles and arrays of them are not.
+ */
+
 bool Type::isDouble() const
 {
-	return _specifier == DOUBLE;
+    return _bits & REAL;
 }
 
 
@@ -193,76 +325,134 @@ bool Type::isDouble() const
 
 int Type::specifier() const
 {
-    return _specifier;
+    return entry().specifier;
 }
 
 unsigned Type::indirection() const
 {
-    return _indirection;
+    return entry().indirection;
 }
 
 unsigned Type::length() const
 {
-    assert(_declarator == ARRAY);
-    return _length;
+    assert(isArray());
+    return entry().length;
+}
+
+const Parameters *Type::parameters() const
+{
+    assert(isFunction());
+    return entry().parameters;
 }
 
-Parameters *Type::parameters() const
+
+/*
+ * Function:	Type::size
+ *
+ * Description:	Return the size of this type in bytes under the given data
+ *		layout.  A function or the error type has no size, and
+ *		neither does a type with any other specifier, so zero is
+ *		returned for them.
+ */
+
+size_t Type::size(const DataLayout &layout) const
 {
-    assert(_declarator == FUNCTION);
-    return _parameters;
+    size_t size;
+
+
+    if (isError() || isFunction())
+	return 0;
+
+    if (indirection() > 0)
+	size = layout.pointer;
+    else if (specifier() == CHAR)
+	size = layout.character;
+    else if (specifier() == INT)
+	size = layout.integer;
+    else if (specifier() == DOUBLE)
+	size = layout.real;
+    else
+	size = 0;
+
+    return isArray() ? size * length() : size;
+}
+
+
+/*
+ * Function:	Type::index (accessor)
+ *
+ * Description:	Return the index of this type in the table.
+ */
+
+unsigned Type::index() const
+{
+    return _bits & INDEX;
+}
+
+
+/*
+ * Function:	Type::classify
+ *
+ * Description:	Return the class of this type, which is found from its
+ *		declarator, the code for its specifier, and whether it is a
+ *		pointer once promoted.
+ */
+
+TypeClass Type::classify() const
+{
+    unsigned kind = (_bits & SPECIFIER) >> 25;
+
+
+    if (isError())
+	return ERROR_CLASS;
+
+    if (isFunction())
+	return FUNCTION_CLASS;
+
+    if (_bits & POINTER)
+	return TypeClass(CHAR_POINTER + kind);
+
+    return TypeClass(CHAR_CLASS + kind);
 }
 
 //Phase 4 stuff
 
 Type Type::promote() const
 {
-	cout << "promote" << endl;
-	cout << _specifier << " " << _indirection << " " <<_declarator << endl;
-	if(_specifier == CHAR && _declarator == SCALAR && _indirection == 0)
-	{
-		return Type(INT);
-	}
-
-	if(_declarator == ARRAY)
+	TRACE(TYPES, "promote: " << *this);
+	if(_bits & PROMOTES)
 	{
-		return Type(_specifier, _indirection + 1);
+		return Type(entry().promoted);
 	}
 	return *this;
 }
 
 bool Type::isNumeric() const
 {
-	Type temp = this->promote();
-	cout << temp.isDouble() << "isNumeric" << (temp == Type(INT)) << endl;
-	return ((temp == Type(DOUBLE)) || (temp == Type(INT)));
+	TRACE(TYPES, "isNumeric: " << *this);
+	return _bits & NUMERIC;
 }
 
 bool Type::isPredicate() const
 {
-	cout << "isPredicate" << endl; 
-	Type temp = this->promote();
-	cout << temp << endl;
-	return (temp.isNumeric() || temp.isPointer());
+	TRACE(TYPES, "isPredicate: " << *this);
+	return _bits & (NUMERIC | POINTER);
 }
 
 bool Type::isPointer() const
 {
-	Type temp = this->promote();
-	cout << temp << " ispointer" << endl;
-	return (temp.isArray() || (temp.isScalar() && temp.indirection() > 0));
+	TRACE(TYPES, "isPointer: " << *this);
+	return _bits & POINTER;
 }
 
 bool Type::isCompatibleWith(const Type& that) const
 {
+	TRACE(TYPES, "isCompatibleWith: " << *this << ", " << that);
 	if(isNumeric() && that.isNumeric()){
-		cout << "first compat" << endl;
         return true;
     }
-	cout << "compat predicate" << endl;
 	if (that.isPredicate() && this->isPredicate())
 	{
-		cout << "here buggy" << endl;
 		return (*this == that);
 	}
 	return false;
@@ -322,3 +512,151 @@ ostream &operator <<(ostream &ostr, const Type &type)
 
     return ostr;
 }
+
+
+/*
+ * Function:	Parameters::operator ==
+ *
+ * Description:	Return whether another parameter list is equal to this
+ *		list.
+ */
+
+bool Parameters::operator ==(const Parameters &rhs) const
+{
+    return variadic == rhs.variadic && types == rhs.types;
+}
+
+
+/*
+ * Function:	TypeEntry::operator ==
+ *
+ * Description:	Return whether another entry describes the same type as
+ *		this entry.  Parameter lists are in the table only once, so
+ *		they are compared by address.  The promoted form follows
+ *		from the rest.
+ */
+
+bool TypeEntry::operator ==(const TypeEntry &rhs) const
+{
+    return declarator == rhs.declarator && specifier == rhs.specifier
+	&& indirection == rhs.indirection && length == rhs.length
+	&& parameters == rhs.parameters;
+}
+
+
+/*
+ * Function:	TypeTable::Hash::operator ()
+ *
+ * Description:	Return the hash of the given entry or parameter list.
+ */
+
+size_t TypeTable::Hash::operator ()(const TypeEntry &entry) const
+{
+    size_t h;
+
+
+    h = entry.declarator;
+    h = h * 31 + entry.specifier;
+    h = h * 31 + entry.indirection;
+    h = h * 31 + entry.length;
+    return h * 31 + hash<const void *>()(entry.parameters);
+}
+
+size_t TypeTable::Hash::operator ()(const Parameters &parameters) const
+{
+    size_t h = parameters.variadic;
+
+
+    for (auto &type : parameters.types)
+	h = h * 31 + type.index();
+
+    return h;
+}
+
+
+/*
+ * Function:	TypeTable::TypeTable (constructor)
+ *
+ * Description:	Initialize this table with the error type and the preset
+ *		scalar types, in the order in which Type::preset expects
+ *		them.
+ */
+
+TypeTable::TypeTable()
+    : _size(0)
+{
+    static const int specifiers[] = {CHAR, INT, DOUBLE};
+
+
+    add(TypeEntry{Type::ERROR, 0, 0, 0, nullptr, 0});
+
+    for (auto specifier : specifiers)
+	for (unsigned i = 0; i < Type::PRESET; i ++)
+	    add(TypeEntry{Type::SCALAR, (short) specifier, i, 0, nullptr,
+		specifier == CHAR && i == 0 ? Type(INT)._bits : 0});
+
+    assert(_size == Type::preset(DOUBLE, Type::PRESET - 1) + 1);
+}
+
+
+/*
+ * Function:	TypeTable::add
+ *
+ * Description:	Return the index of the type with the given entry, adding
+ *		it to the table if it is not already there.  The entries are
+ *		kept in blocks, each twice as large as the one before, so
+ *		that an entry never moves once added.
+ */
+
+unsigned TypeTable::add(const TypeEntry &entry)
+{
+    lock_guard<mutex> lock(_adding);
+    unsigned block, offset;
+
+
+    auto it = _index.find(entry);
+
+    if (it != _index.end())
+	return it->second;
+
+    block = 31 - __builtin_clz(_size + FIRST) - SHIFT;
+    offset = _size + FIRST - (FIRST << block);
+
+    if (_blocks[block] == nullptr)
+	_blocks[block].reset(new TypeEntry[FIRST << block]);
+
+    _blocks[block][offset] = entry;
+    _index.emplace(entry, _size);
+    return _size ++;
+}
+
+
+/*
+ * Function:	TypeTable::add
+ *
+ * Description:	Return the copy in the table of the given parameter list,
+ *		adding it if it is not already there.
+ */
+
+const Parameters *TypeTable::add(const Parameters &parameters)
+{
+    lock_guard<mutex> lock(_adding);
+    return &*_parameters.insert(parameters).first;
+}
+
+
+/*
+ * Function:	TypeTable::operator []
+ *
+ * Description:	Return the entry for the type with the given index.  The
+ *		type must have been added by this thread, or by another
+ *		before this thread learned of it, so no lock is needed.
+ */
+
+const TypeEntry &TypeTable::operator [](unsigned index) const
+{
+    unsigned block = 31 - __builtin_clz(index + FIRST) - SHIFT;
+
+
+    return _blocks[block][index + FIRST - (FIRST << block)];
+}
@@ -16,31 +16,99 @@
  *		As we've designed them, types are essentially immutable,
  *		since we haven't included any mutators.  In practice, we'll
  *		be creating new types rather than changing existing types.
+ *
+ *		Every distinct type is kept exactly once in the type table
+ *		of the current context, and a type is just its index in the
+ *		table, so types are compared by comparing their indices.
+ *		Parameter lists are kept once in the table as well, so two
+ *		function types share a list if they have the same one.  The
+ *		table is filled first with the error type and the scalar
+ *		types with few levels of indirection, in the same order in
+ *		every context, so that those types never need to be looked
+ *		up, and can even be created without a context.
+ *
+ *		The index takes only the low bits of a type.  The high bits
+ *		hold its declarator, a code for its specifier, and its
+ *		properties, such as whether it is an integer, a double,
+ *		numeric, or a pointer once promoted, which are computed once
+ *		when the type is made.  So
+ *		the predicates are just masks, and only the specifier,
+ *		indirection, length, and parameters of a type, and its
+ *		promoted form if different, are found in the table.
+ *
+ *		For the operator tables of the checker, each type also falls
+ *		into one of a few classes, by its specifier and whether it
+ *		is a pointer once promoted, which is found from its bits.
+ *		Any specifier other than char, int, and double falls into
+ *		the same class, but none is ever given.
+ *
+ *		The size of a type depends on the target, and is found from
+ *		a data layout giving the sizes of the scalar types.
+ *
+ *		Entries are never moved once added, so they may be read
+ *		without a lock, but a lock is taken to add them, since the
+ *		functions of a translation unit may be checked at once.
  */
 
 # ifndef TYPE_H
 # define TYPE_H
-# include <vector>
+# include <cstdint>
+# include <memory>
+# include <mutex>
 # include <ostream>
+# include <unordered_map>
+# include <unordered_set>
+# include <vector>
+
+enum TypeClass {
+    ERROR_CLASS, FUNCTION_CLASS,
+    CHAR_CLASS, INT_CLASS, DOUBLE_CLASS, OTHER_CLASS,
+    CHAR_POINTER, INT_POINTER, DOUBLE_POINTER, OTHER_POINTER,
+    NUM_CLASSES
+};
+
+struct DataLayout {
+    unsigned character, integer, real, pointer;
+};
+
+extern const DataLayout LP64, ILP32;
 
 struct Parameters {
     bool variadic;
     std::vector<class Type> types;
+
+    bool operator ==(const Parameters &rhs) const;
 };
 
 class Type {
     enum {ARRAY, ERROR, FUNCTION, SCALAR};
+    enum { PRESET = 8 };
+
+    enum : uint32_t {
+	INDEX = (1u << 23) - 1,
+	DECLARATOR = 3u << 23,
+	SPECIFIER = 3u << 25,
+	INTEGRAL = 1u << 27,
+	REAL = 1u << 28,
+	NUMERIC = 1u << 29,
+	POINTER = 1u << 30,
+	PROMOTES = 1u << 31,
+    };
+
+    uint32_t _bits;
 
-    short _declarator, _specifier;
-    unsigned _indirection;
-    unsigned _length;
-    Parameters *_parameters;
+    explicit Type(uint32_t bits);
+    const struct TypeEntry &entry() const;
+    static unsigned code(int specifier);
+    static unsigned preset(int specifier, unsigned indirection);
+    static uint32_t pack(unsigned index, const TypeEntry &entry);
+    friend class TypeTable;
 
 public:
     Type();
     Type(int specifier, unsigned indirection = 0);
     Type(int specifier, unsigned indirection, unsigned length);
-    Type(int specifier, unsigned indirection, Parameters *parameters);
+    Type(int specifier, unsigned indirection, const Parameters &parameters);
 
     bool operator ==(const Type &rhs) const;
     bool operator !=(const Type &rhs) const;
@@ -60,8 +128,40 @@ public:
     int specifier() const;
     unsigned indirection() const;
     unsigned length() const;
-    Parameters *parameters() const;
+    const Parameters *parameters() const;
+    size_t size(const DataLayout &layout) const;
+
+    unsigned index() const;
+    TypeClass classify() const;
+};
+
+struct TypeEntry {
+    short declarator, specifier;
+    unsigned indirection, length;
+    const Parameters *parameters;
+    uint32_t promoted;
+
+    bool operator ==(const TypeEntry &rhs) const;
+};
+
+class TypeTable {
+    struct Hash {
+	size_t operator ()(const TypeEntry &entry) const;
+	size_t operator ()(const Parameters &parameters) const;
+    };
+
+    std::unique_ptr<TypeEntry[]> _blocks[32];
+    unsigned _size;
+    std::unordered_map<TypeEntry, unsigned, Hash> _index;
+    std::unordered_set<Parameters, Hash> _parameters;
+    std::mutex _adding;
+
+public:
+    TypeTable();
 
+    unsigned add(const TypeEntry &entry);
+    const Parameters *add(const Parameters &parameters);
+    const TypeEntry &operator [](unsigned index) const;
 };
 
 std::ostream &operator <<(std::ostream &ostr, const Type &type);
@@ -7,44 +7,357 @@
  *		If a symbol is redeclared, the redeclaration is discarded
  *		and the original declaration is retained.
  *
+ *		The outermost scope belongs to the current context, but each
+ *		thread has its own top-level scope, so that the bodies of
+ *		several functions may be checked at once.
+ *
+ *		Each thread also keeps a flat table of the symbols declared
+ *		in its open scopes other than the outermost, indexed by name
+ *		and holding the innermost declaration of each.  Declaring a
+ *		symbol logs the declaration it shadows, and closing a scope
+ *		restores them, so the table holds a stack of declarations
+ *		for each name.  An identifier is thus found without walking
+ *		the enclosing scopes, or else in the outermost scope, as far
+ *		as it is visible from the function being checked.
+ *
+ *		The outermost scope and its symbols are allocated on the
+ *		heap, but every other scope and symbol is allocated from the
+ *		arena of the function being checked.
+ *
+ *		Constant operands are folded following C's rules for int
+ *		and double, with int taken to be 32 bits and char signed.
+ *		An operation whose result C leaves undefined, such as
+ *		division by zero, is not folded but left for run time.
+ *
  *		Extra functionality:
  *		- inserting an undeclared symbol with the error type
  */
 
-# include <iostream>
-# include <unordered_set>
-# include "lexer.h"
+# include <climits>
+# include <vector>
+# include "source.h"
 # include "checker.h"
+# include "CompilerContext.h"
 # include "tokens.h"
 # include "Symbol.h"
 # include "Scope.h"
 # include "Type.h"
+# include "trace.h"
 
 
 using namespace std;
 
-#define E1 "break statement not within loop"
-#define E2 "invalid return type"
-#define E3 "invalid type for test expression"
-#define E4 "lvalue required in expression"
-#define E5 "invalid operands to binary %s"
-#define E6 "invalid operand to unary %s"
-#define E7 "invalid operand in sizeof expression"
-#define E8 "invalid operand in cast expression"
-#define E9 "called object is not a function"
-#define E10 "invalid arguments to called function"
-
-static unordered_set<string> defined;
-static Scope *outermost, *toplevel;
+static thread_local Scope *toplevel, *enclosed;
+static thread_local Arena *arena;
+static thread_local vector<Symbol *> bindings;
+static thread_local vector<pair<Name, Symbol *>> shadowed;
+static thread_local vector<size_t> marks;
 static const Type error;
 static Type integer(INT);
 static Type real(DOUBLE);
 static Type character(CHAR);
 
-static string redefined = "redefinition of '%s'";
-static string redeclared = "redeclaration of '%s'";
-static string conflicting = "conflicting types for '%s'";
-static string undeclared = "'%s' undeclared";
+
+/*
+ * The result of each arithmetic, logical, and cast operator depends only
+ * on the classes of its operands, and is one of a few outcomes: an error
+ * that is reported, an error that is not, since one was already reported
+ * for an operand, int, double, an operand promoted, the type an
+ * operand points to, or the type of a cast.  Comparing two pointers also
+ * needs the types themselves, which must be equal.  The outcomes are
+ * tabulated at compile time from the rules below, and the assertions
+ * that follow pin the tables to the rules as they have always been.
+ */
+
+enum Outcome {
+    INVALID, SILENT, AS_INT, AS_DOUBLE, PROMOTED_LEFT,
+    PROMOTED_RIGHT, IF_EQUAL, DEREFERENCED, AS_CAST
+};
+
+static constexpr bool numeric(unsigned c)
+{
+    return c == CHAR_CLASS || c == INT_CLASS || c == DOUBLE_CLASS;
+}
+
+static constexpr bool integral(unsigned c)
+{
+    return c == CHAR_CLASS || c == INT_CLASS;
+}
+
+static constexpr bool pointer(unsigned c)
+{
+    return c >= CHAR_POINTER && c <= OTHER_POINTER;
+}
+
+static constexpr bool predicate(unsigned c)
+{
+    return numeric(c) || pointer(c);
+}
+
+static constexpr Outcome arithmetic(unsigned l, unsigned r)
+{
+    return l == DOUBLE_CLASS || r == DOUBLE_CLASS ? AS_DOUBLE : AS_INT;
+}
+
+struct DivMul {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	return numeric(l) && numeric(r) ? arithmetic(l, r) : INVALID;
+    }
+};
+
+struct Mod {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	return integral(l) && integral(r) ? AS_INT : INVALID;
+    }
+};
+
+struct Add {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	if (numeric(l) && numeric(r))
+	    return arithmetic(l, r);
+
+	if (pointer(l) && integral(r))
+	    return PROMOTED_LEFT;
+
+	if (integral(l) && pointer(r))
+	    return PROMOTED_RIGHT;
+
+	return INVALID;
+    }
+};
+
+struct Sub {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	if (numeric(l) && numeric(r))
+	    return arithmetic(l, r);
+
+	if (pointer(l) && r == INT_CLASS)
+	    return PROMOTED_LEFT;
+
+	if (pointer(l) && pointer(r) && l == r)
+	    return AS_INT;
+
+	return INVALID;
+    }
+};
+
+struct Equality {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	if (numeric(l) && numeric(r))
+	    return AS_INT;
+
+	return predicate(l) && l == r ? IF_EQUAL : INVALID;
+    }
+};
+
+struct Logical {
+    static constexpr Outcome rule(unsigned l, unsigned r) {
+	if (l == ERROR_CLASS || r == ERROR_CLASS)
+	    return SILENT;
+
+	return predicate(l) && predicate(r) ? AS_INT : INVALID;
+    }
+};
+
+struct Cast {
+    static constexpr Outcome rule(unsigned result, unsigned operand) {
+	if (numeric(result) && numeric(operand))
+	    return AS_CAST;
+
+	if (pointer(result) && (pointer(operand) || operand == INT_CLASS))
+	    return AS_CAST;
+
+	return result == INT_CLASS && pointer(operand) ? AS_CAST : INVALID;
+    }
+};
+
+struct Not {
+    static constexpr Outcome rule(unsigned c) {
+	return predicate(c) ? AS_INT : INVALID;
+    }
+};
+
+struct Negate {
+    static constexpr Outcome rule(unsigned c) {
+	return numeric(c) ? PROMOTED_LEFT : INVALID;
+    }
+};
+
+struct Dereference {
+    static constexpr Outcome rule(unsigned c) {
+	return pointer(c) ? DEREFERENCED : INVALID;
+    }
+};
+
+template <class Rule>
+struct BinaryTable {
+    Outcome cells[NUM_CLASSES][NUM_CLASSES];
+
+    constexpr BinaryTable() : cells() {
+	for (unsigned l = 0; l < NUM_CLASSES; l ++)
+	    for (unsigned r = 0; r < NUM_CLASSES; r ++)
+		cells[l][r] = Rule::rule(l, r);
+    }
+
+    Outcome operator ()(const Type &left, const Type &right) const {
+	return cells[left.classify()][right.classify()];
+    }
+};
+
+template <class Rule>
+struct UnaryTable {
+    Outcome cells[NUM_CLASSES];
+
+    constexpr UnaryTable() : cells() {
+	for (unsigned c = 0; c < NUM_CLASSES; c ++)
+	    cells[c] = Rule::rule(c);
+    }
+
+    Outcome operator ()(const Type &operand) const {
+	return cells[operand.classify()];
+    }
+};
+
+static constexpr BinaryTable<DivMul> divMul;
+static constexpr BinaryTable<Mod> mod;
+static constexpr BinaryTable<Add> add;
+static constexpr BinaryTable<Sub> sub;
+static constexpr BinaryTable<Equality> equality;
+static constexpr BinaryTable<Logical> logical;
+static constexpr BinaryTable<Cast> cast;
+static constexpr UnaryTable<Not> logicalNot;
+static constexpr UnaryTable<Negate> unaryMinus;
+static constexpr UnaryTable<Dereference> dereference;
+
+static_assert(divMul.cells[CHAR_CLASS][INT_CLASS] == AS_INT);
+static_assert(divMul.cells[DOUBLE_CLASS][CHAR_CLASS] == AS_DOUBLE);
+static_assert(divMul.cells[INT_POINTER][INT_CLASS] == INVALID);
+static_assert(divMul.cells[FUNCTION_CLASS][ERROR_CLASS] == SILENT);
+static_assert(mod.cells[CHAR_CLASS][INT_CLASS] == AS_INT);
+static_assert(mod.cells[INT_CLASS][DOUBLE_CLASS] == INVALID);
+static_assert(add.cells[CHAR_CLASS][CHAR_CLASS] == AS_INT);
+static_assert(add.cells[INT_CLASS][DOUBLE_CLASS] == AS_DOUBLE);
+static_assert(add.cells[INT_POINTER][CHAR_CLASS] == PROMOTED_LEFT);
+static_assert(add.cells[INT_CLASS][DOUBLE_POINTER] == PROMOTED_RIGHT);
+static_assert(add.cells[INT_POINTER][INT_POINTER] == INVALID);
+static_assert(add.cells[DOUBLE_CLASS][CHAR_POINTER] == INVALID);
+static_assert(add.cells[ERROR_CLASS][FUNCTION_CLASS] == SILENT);
+static_assert(sub.cells[CHAR_POINTER][INT_CLASS] == PROMOTED_LEFT);
+static_assert(sub.cells[CHAR_POINTER][CHAR_CLASS] == INVALID);
+static_assert(sub.cells[CHAR_POINTER][CHAR_POINTER] == AS_INT);
+static_assert(sub.cells[CHAR_POINTER][INT_POINTER] == INVALID);
+static_assert(sub.cells[INT_CLASS][INT_POINTER] == INVALID);
+static_assert(equality.cells[CHAR_CLASS][DOUBLE_CLASS] == AS_INT);
+static_assert(equality.cells[INT_POINTER][INT_POINTER] == IF_EQUAL);
+static_assert(equality.cells[INT_POINTER][CHAR_POINTER] == INVALID);
+static_assert(equality.cells[INT_CLASS][INT_POINTER] == INVALID);
+static_assert(equality.cells[FUNCTION_CLASS][FUNCTION_CLASS] == INVALID);
+static_assert(logical.cells[INT_POINTER][DOUBLE_CLASS] == AS_INT);
+static_assert(logical.cells[FUNCTION_CLASS][INT_CLASS] == INVALID);
+static_assert(logical.cells[INT_CLASS][ERROR_CLASS] == SILENT);
+static_assert(cast.cells[DOUBLE_CLASS][CHAR_CLASS] == AS_CAST);
+static_assert(cast.cells[CHAR_POINTER][DOUBLE_POINTER] == AS_CAST);
+static_assert(cast.cells[INT_POINTER][INT_CLASS] == AS_CAST);
+static_assert(cast.cells[INT_POINTER][CHAR_CLASS] == INVALID);
+static_assert(cast.cells[INT_CLASS][DOUBLE_POINTER] == AS_CAST);
+static_assert(cast.cells[CHAR_CLASS][DOUBLE_POINTER] == INVALID);
+static_assert(cast.cells[INT_CLASS][ERROR_CLASS] == INVALID);
+static_assert(logicalNot.cells[DOUBLE_POINTER] == AS_INT);
+static_assert(logicalNot.cells[ERROR_CLASS] == INVALID);
+static_assert(unaryMinus.cells[CHAR_CLASS] == PROMOTED_LEFT);
+static_assert(unaryMinus.cells[INT_POINTER] == INVALID);
+static_assert(dereference.cells[CHAR_POINTER] == DEREFERENCED);
+static_assert(dereference.cells[INT_CLASS] == INVALID);
+
+
+/*
+ * Function:	result
+ *
+ * Description:	Return the type given by the outcome of an operator on
+ *		the given operands.  Any error has already been reported.
+ */
+
+static Type result(Outcome outcome, const Type &left, const Type &right)
+{
+    switch (outcome) {
+    case AS_INT:
+    case IF_EQUAL:
+	return integer;
+
+    case AS_DOUBLE:
+	return real;
+
+    case PROMOTED_LEFT:
+	return left.promote();
+
+    case PROMOTED_RIGHT:
+	return right.promote();
+
+    case DEREFERENCED:
+	return Type(left.specifier(), left.indirection() - 1);
+
+    case AS_CAST:
+	return right;
+
+    default:
+	return error;
+    }
+}
+
+
+/*
+ * Function:	bind
+ *
+ * Description:	Make the given symbol the innermost declaration of its
+ *		name, logging the declaration it shadows.
+ */
+
+static void bind(Symbol *symbol)
+{
+    Name id = symbol->id();
+
+
+    if (id >= bindings.size())
+	bindings.resize(numnames());
+
+    shadowed.emplace_back(id, bindings[id]);
+    bindings[id] = symbol;
+}
+
+
+/*
+ * Function:	enter
+ *
+ * Description:	Make the given scope, which is not the outermost scope,
+ *		the new top-level scope, and mark where its declarations
+ *		start in the log.  A scope enclosed by the outermost scope
+ *		is that of a function, and is remembered as the scope
+ *		from which the outermost scope is seen.
+ */
+
+static void enter(Scope *scope)
+{
+    toplevel = scope;
+    marks.push_back(shadowed.size());
+
+    if (scope->enclosing() == context->outermost)
+	enclosed = scope;
+}
 
 
 /*
@@ -55,10 +368,10 @@ static string undeclared = "'%s' undeclared";
 
 Scope *openScope()
 {
-    toplevel = new Scope(toplevel);
-
-    if (outermost == nullptr)
-	    outermost = toplevel;
+    if (context->outermost == nullptr)
+	toplevel = context->outermost = new Scope(toplevel);
+    else
+	enter(arena->make<Scope>(toplevel));
 
     return toplevel;
 }
@@ -68,34 +381,117 @@ Scope *openScope()
  * Function:	closeScope
  *
  * Description:	Remove the top-level scope, and make its enclosing scope
- *		the new top-level scope.
+ *		the new top-level scope.  Closing the outermost scope ends
+ *		the translation unit, and forgets the functions defined in
+ *		it.  Otherwise, the declarations the scope shadowed are
+ *		restored.
  */
 
 Scope *closeScope()
 {
     Scope *old = toplevel;
     toplevel = toplevel->enclosing();
+
+    if (old == context->outermost) {
+	context->outermost = nullptr;
+	context->defined.clear();
+	return old;
+    }
+
+    while (shadowed.size() > marks.back()) {
+	bindings[shadowed.back().first] = shadowed.back().second;
+	shadowed.pop_back();
+    }
+
+    marks.pop_back();
     return old;
 }
 
 
+/*
+ * Function:	reopenScope
+ *
+ * Description:	Make a scope that was closed the top-level scope again.
+ *		Its enclosing scope becomes the top-level scope once it is
+ *		closed again.
+ */
+
+Scope *reopenScope(Scope *scope)
+{
+    enter(scope);
+
+    for (auto symbol : scope->symbols())
+	bind(symbol);
+
+    return scope;
+}
+
+
+/*
+ * Function:	allocateFrom
+ *
+ * Description:	Allocate the scopes and symbols of the function being
+ *		checked on this thread from the given arena.
+ */
+
+void allocateFrom(Arena *a)
+{
+    arena = a;
+}
+
+
+/*
+ * Function:	declare
+ *
+ * Description:	Create a symbol with the given NAME and TYPE and insert it
+ *		into the top-level scope.
+ */
+
+static Symbol *declare(Name name, const Type &type)
+{
+    Symbol *symbol;
+
+
+    if (toplevel == context->outermost) {
+	symbol = new Symbol(name, type);
+	toplevel->insert(symbol);
+	return symbol;
+    }
+
+    symbol = arena->make<Symbol>(name, type);
+    toplevel->insert(symbol);
+
+    bind(symbol);
+    return symbol;
+}
+
+
 /*
  * Function:	defineFunction
  *
  * Description:	Define a function with the specified NAME and TYPE.  A
- *		function is always defined in the outermost scope.
+ *		function is always defined in the outermost scope, and is
+ *		visible from its parameter scope, which is already open.
  */
 
-Symbol *defineFunction(const string &name, const Type &type)
+Symbol *defineFunction(Name name, const Type &type)
 {
-    if (defined.count(name) > 0) 
+    Symbol *symbol;
+
+
+    if (name < context->defined.size() && context->defined[name]) 
     {
-        report(redefined, name);
-        return outermost->find(name);
+        report(REDEFINED, spelling(name));
+        return context->outermost->find(name);
     }
 
-    defined.insert(name);
-    return declareFunction(name, type);
+    if (name >= context->defined.size())
+        context->defined.resize(numnames());
+
+    context->defined[name] = true;
+    symbol = declareFunction(name, type);
+    toplevel->reveal();
+    return symbol;
 }
 
 
@@ -107,23 +503,18 @@ Symbol *defineFunction(const string &name, const Type &type)
  *		redeclaration is discarded.
  */
 
-Symbol *declareFunction(const string &name, const Type &type)
+Symbol *declareFunction(Name name, const Type &type)
 {
-    cout << name << ": " << type << endl;
-    Symbol *symbol = outermost->find(name);
+    TRACE(CHECKER, "declareFunction: " << spelling(name) << ": " << type);
+    Symbol *symbol = context->outermost->find(name);
 
     if (symbol == nullptr) 
     {
         symbol = new Symbol(name, type);
-        outermost->insert(symbol);
+        context->outermost->insert(symbol);
     } 
     else if (type != symbol->type()) 
-    {
-        report(conflicting, name);
-        delete type.parameters();
-    } 
-    else
-	    delete type.parameters();
+        report(CONFLICTING, spelling(name));
 
     return symbol;
 }
@@ -136,33 +527,49 @@ Symbol *declareFunction(const string &name, const Type &type)
  *		redeclaration is discarded.
  */
 
-Symbol *declareVariable(const string &name, const Type &type)
+Symbol *declareVariable(Name name, const Type &type)
 {
-    cout << name << ": " << type << endl;
+    TRACE(CHECKER, "declareVariable: " << spelling(name) << ": " << type);
     Symbol *symbol = toplevel->find(name);
 
     if (symbol == nullptr) 
     {
-        symbol = new Symbol(name, type);
-        toplevel->insert(symbol);
+        symbol = declare(name, type);
     } 
-    else if (outermost != toplevel)
-	    report(redeclared, name);
+    else if (context->outermost != toplevel)
+	    report(REDECLARED, spelling(name));
 
     else if (type != symbol->type())
-	    report(conflicting, name);
+	    report(CONFLICTING, spelling(name));
 
     return symbol;
 }
 
-Symbol *checkIdentifier(const string &name)
+
+/*
+ * Function:	checkIdentifier
+ *
+ * Description:	Find the nearest declaration of the identifier with the
+ *		specified NAME.  An undeclared identifier is declared with
+ *		the error type in the top-level scope.
+ */
+
+Symbol *checkIdentifier(Name name)
 {
-    Symbol *symbol = toplevel->lookup(name);
+    Symbol *symbol = nullptr;
+
+
+    if (toplevel == context->outermost)
+	symbol = toplevel->find(name);
+    else if (name < bindings.size() && bindings[name] != nullptr)
+	symbol = bindings[name];
+    else
+	symbol = context->outermost->find(name, enclosed->visible());
+
     if (symbol == nullptr) 
     {
-        report(undeclared, name);
-        symbol = new Symbol(name, error);
-        toplevel->insert(symbol);
+        report(UNDECLARED, spelling(name));
+        symbol = declare(name, error);
     }
     return symbol;
 }
@@ -214,7 +621,7 @@ Type checkAddr(const Type& left, bool& lvalue)
     {
         return Type(left.specifier(), left.indirection()+1);
     }
-    cout << "checkAddr error" << lvalue << endl;
+    TRACE(CHECKER, "checkAddr: operand is not an lvalue");
     report(E4);
     return error;
 }
@@ -227,13 +634,13 @@ Type checkAssignment(const Type& left, const Type& right, bool& left_lvalue)
     }
     if(left_lvalue == false)
     {
-        cout << "checkAssignment error" << left_lvalue << endl;
+        TRACE(CHECKER, "checkAssignment: left operand is not an lvalue");
         report(E4);
         return error;
     }
     if(left.isCompatibleWith(right) == false)
     {
-        cout << "checkAssignment = error" << left_lvalue << endl;
+        TRACE(CHECKER, "checkAssignment: " << left << " = " << right);
         report(E5, "=");
         return error;
     }
@@ -250,12 +657,11 @@ Type checkIndex(const Type& left, const Type& right)
     Type lt = left.promote();
     Type rt = right.promote();
 
-    cout << lt.isPointer() << rt.isInteger() << rt.specifier() << "precheckind" << endl;
+    TRACE(CHECKER, "checkIndex: " << lt << "[" << rt << "]");
     if(lt.isPointer() && (rt == Type(INT)))
     {
         return Type(lt.specifier(), lt.indirection()-1);
     }
-    cout << "checkIndex error" << endl;
     report(E5, "[]");
     return error;
 }
@@ -266,188 +672,119 @@ Type checkIncDec(bool& lvalue)
     {
         return lvalue;
     }
-    cout << "checkIncDec" << lvalue << endl;
+    TRACE(CHECKER, "checkIncDec: operand is not an lvalue");
     report(E4);
 
     return error;
 }
 
-Type checkDivMul(const Type& left, const Type& right, const string& op)
+Type checkDivMul(const Type& left, const Type& right, const char *op)
 {
-    if(left == error || right == error)
-    {
-        return error;
-    }
-    Type lt = left.promote();
-    Type rt = right.promote();
+    Outcome outcome = divMul(left, right);
 
-    if(lt.isNumeric() && rt.isNumeric())
+    if(outcome == INVALID)
     {
-        if(left == Type(DOUBLE) || right == Type(DOUBLE))
-        {
-            return real;
-        }
-        else
-        {
-            return integer;
-        }
+        TRACE(CHECKER, "checkDivMul: " << left << " " << op << " " << right);
+        report(E5, op);
     }
-    cout << "check div mul error" << endl;
-    report(E5, op);
-    return error;
+    return result(outcome, left, right);
 }
 
 Type checkMod(const Type& left, const Type& right)
 {
-    if(left == error || right == error)
-    {
-        return error;
-    }
-    Type lt = left.promote();
-    Type rt = right.promote();
+    Outcome outcome = mod(left, right);
 
-    if(lt == Type(INT) && rt == Type(INT))
+    if(outcome == INVALID)
     {
-        return integer;
+        report(E5, "%");
     }
-    report(E5, "%");
-    return error;
+    return result(outcome, left, right);
 }
 
-//Check this
 Type checkAdd(const Type& left, const Type& right)
 {
-    if(left == error || right == error)
-    {
-        return error;
-    }
-
-    Type lt = left.promote();
-    Type rt = right.promote();
+    Outcome outcome = add(left, right);
 
-    if(lt.isNumeric() && rt.isNumeric())
-    {
-        if(lt.specifier() == DOUBLE || rt.specifier() == DOUBLE)
-        {
-            return real;
-        }
-        else
-        {
-            return integer;
-        }
-    }
-    else if(lt.isPointer() && (rt == Type(INT)))
-    { 
-        return lt;
-    }
-    else if((lt == Type(INT)) && rt.isPointer())
+    if(outcome == INVALID)
     {
-        return rt;
+        TRACE(CHECKER, "checkAdd: " << left << " + " << right);
+        report(E5, "+");
     }
-    cout << "checkAdd error" << endl;
-    report(E5, "+");
-    return error;
+    return result(outcome, left, right);
 }
 
-//Check this
 Type checkSub(const Type& left, const Type& right)
 {
-    if(left == error || right == error)
-    {
-        return error;
-    }
+    Outcome outcome = sub(left, right);
 
-    Type lt = left.promote();
-    Type rt = right.promote();
-
-    if(lt.isNumeric() and rt.isNumeric())
+    if(outcome == INVALID)
     {
-
-        if(lt.specifier() == DOUBLE || rt.specifier() == DOUBLE)
-        {
-            return real;
-        }
-        else
-        {
-            return integer;
-        }
+        TRACE(CHECKER, "checkSub: " << left << " - " << right);
+        report(E5, "-");
     }
-    else if(lt.isPointer() && (right == Type(INT)))
-    { 
-        return lt;
-    }
-    else if(lt.isPointer() && rt.isPointer() && lt.specifier() == rt.specifier())
-    { 
-        return integer;
-    }
-    cout << "checkSub Error" << endl;
-    report(E5, "-");
-    return error;
+    return result(outcome, left, right);
 }
 
-Type checkEQs(const Type& left, const Type& right, const string &op)
+Type checkEQs(const Type& left, const Type& right, const char *op)
 {
-    if(left == error || right == error)
+    Outcome outcome = equality(left, right);
+
+    if(outcome == IF_EQUAL && left != right)
     {
-        return error;
+        outcome = INVALID;
     }
-    if(left.isCompatibleWith(right))
+    if(outcome == INVALID)
     {
-        return integer;
+        TRACE(CHECKER, "checkEQs: " << left << " " << op << " " << right);
+        report(E5, op);
     }
-    cout << "checkEQs error" << endl;
-    report(E5, op);
-    return error;
+    return result(outcome, left, right);
 }
 
-Type checkLogical(const Type& left, const Type& right, const string &op)
+Type checkLogical(const Type& left, const Type& right, const char *op)
 {
-    const Type &t1 = left.promote();
-    const Type &t2 = right.promote();
-    Type result = error;
-    if(t1 != error && t2 != error)
+    Outcome outcome = logical(left, right);
+
+    if(outcome == INVALID)
     {
-        if(t1.isPredicate() && t2.isPredicate())
-        {
-            result = integer;
-        }
-        else
-        {
-            cout << "Checklogical error" << endl;
-            report(E5, op);
-        }
+        TRACE(CHECKER, "checkLogical: " << left.promote() << " " << op
+            << " " << right.promote());
+        report(E5, op);
     }
-    return result;
+    return result(outcome, left, right);
 }
 
 Type checkNot(const Type& left)
 {
-    if(left.isPredicate())
+    Outcome outcome = logicalNot(left);
+
+    if(outcome == INVALID)
     {
-        return integer;
+        report(E6, "!");
     }
-    report(E6, "!");
-    return error;
+    return result(outcome, left, left);
 }
 
 Type checkNEG(const Type& left)
 {
-    if(left.isNumeric())
+    Outcome outcome = unaryMinus(left);
+
+    if(outcome == INVALID)
     {
-        return left;
+        report(E6, "-");
     }
-    report(E6, "-");
-    return error;
+    return result(outcome, left, left);
 }
 
 Type checkDeref(const Type& left)
 {
-    if(left.isPointer())
+    Outcome outcome = dereference(left);
+
+    if(outcome == INVALID)
     {
-        return Type(left.specifier(), left.indirection()-1);
+        report(E6, "*");
     }
-    report(E6, "*");
-    return error;
+    return result(outcome, left, left);
 }
 
 Type checkSizeOf(const Type& left)
@@ -462,44 +799,234 @@ Type checkSizeOf(const Type& left)
 
 Type checkTypeCast(const Type& left, int typespec, unsigned indirection)
 {
-    Type result = Type(typespec, indirection);
+    Type type = Type(typespec, indirection);
+    Outcome outcome = cast(type, left);
 
-    if(result.isNumeric() && left.isNumeric())
+    if(outcome == INVALID)
     {
-        return result;
+        report(E8);
     }
-    else if(result.isPointer() && left.isPointer())
-    {
-        return result;
+    return result(outcome, left, type);
+}
+
+
+/*
+ * Function:	convert
+ *
+ * Description:	Convert a constant VALUE of type FROM to type TO, both of
+ *		which are numeric, and return whether it could be.  A double
+ *		whose integer part does not fit cannot be converted.
+ */
+
+static bool convert(Constant value, const Type &from, const Type &to,
+	Constant &result)
+{
+    int n;
+
+
+    if (!from.isNumeric() || !to.isNumeric())
+	return false;
+
+    if (to.isDouble()) {
+	result.real = from.isDouble() ? value.real : value.integer;
+	return true;
     }
-    else if(result.isPointer() && (left == Type(INT)))
-    {
-        return result;
+
+    if (!from.isDouble())
+	n = value.integer;
+    else if (value.real > INT_MIN - 1.0 && value.real < INT_MAX + 1.0)
+	n = (int) value.real;
+    else
+	return false;
+
+    if (to.specifier() == CHAR) {
+	if (from.isDouble() && (n < SCHAR_MIN || n > SCHAR_MAX))
+	    return false;
+
+	n = (signed char) n;
     }
-    else if((result == Type(INT)) && left.isPointer())
-    {
-        return result;
+
+    result.integer = n;
+    return true;
+}
+
+
+/*
+ * Function:	foldUnary
+ *
+ * Description:	Compute the value of the unary operator OP, whose result
+ *		is of the given TYPE, applied to an OPERAND with a constant
+ *		VALUE, and return whether it could be.  Negation is done on
+ *		the promoted operand, which is also its result, and is not
+ *		folded if it overflows, which is undefined.
+ */
+
+bool foldUnary(int op, const Type &type, const Type &operand, Constant value,
+	Constant &result)
+{
+    Constant computed;
+
+
+    if (type.isError() || !operand.isNumeric())
+	return false;
+
+    if (op == CAST)
+	return convert(value, operand, type, result);
+
+    if (op == NEGATE) {
+	if (operand.isDouble())
+	    result.real = -value.real;
+	else if (__builtin_sub_overflow(0, value.integer, &result.integer))
+	    return false;
+
+	return true;
     }
-    report(E8);
-    return error;
+
+    if (op == LOGICAL_NOT) {
+	computed.integer = operand.isDouble() ? !value.real : !value.integer;
+	return convert(computed, integer, type, result);
+    }
+
+    return false;
+}
+
+
+/*
+ * Function:	foldBinary
+ *
+ * Description:	Compute the value of the binary operator OP, whose result
+ *		is of the given TYPE, applied to operands of types LEFT and
+ *		RIGHT with constant values X and Y, and return whether it
+ *		could be.  If either operand is a double, so is the
+ *		arithmetic.  Integer arithmetic that overflows, and division
+ *		and remainder by zero or of the least int by minus one, are
+ *		undefined and not folded.
+ */
+
+bool foldBinary(int op, const Type &type, const Type &left, Constant x,
+	const Type &right, Constant y, Constant &result)
+{
+    Constant computed;
+    double a, b;
+
+
+    if (type.isError() || !left.isNumeric() || !right.isNumeric())
+	return false;
+
+    if (left.isDouble() || right.isDouble()) {
+	a = left.isDouble() ? x.real : x.integer;
+	b = right.isDouble() ? y.real : y.integer;
+
+	if (op == '+')
+	    computed.real = a + b;
+	else if (op == '-')
+	    computed.real = a - b;
+	else if (op == '*')
+	    computed.real = a * b;
+	else if (op == '/')
+	    computed.real = a / b;
+	else {
+	    if (op == '<')
+		computed.integer = a < b;
+	    else if (op == '>')
+		computed.integer = a > b;
+	    else if (op == LEQ)
+		computed.integer = a <= b;
+	    else if (op == GEQ)
+		computed.integer = a >= b;
+	    else if (op == EQL)
+		computed.integer = a == b;
+	    else if (op == NEQ)
+		computed.integer = a != b;
+	    else if (op == AND)
+		computed.integer = a && b;
+	    else if (op == OR)
+		computed.integer = a || b;
+	    else
+		return false;
+
+	    return convert(computed, integer, type, result);
+	}
+
+	return convert(computed, real, type, result);
+    }
+
+    if ((op == '/' || op == '%') && (y.integer == 0
+	    || (x.integer == INT_MIN && y.integer == -1)))
+	return false;
+
+    if (op == '+') {
+	if (__builtin_add_overflow(x.integer, y.integer, &computed.integer))
+	    return false;
+    } else if (op == '-') {
+	if (__builtin_sub_overflow(x.integer, y.integer, &computed.integer))
+	    return false;
+    } else if (op == '*') {
+	if (__builtin_mul_overflow(x.integer, y.integer, &computed.integer))
+	    return false;
+    } else if (op == '/')
+	computed.integer = x.integer / y.integer;
+    else if (op == '%')
+	computed.integer = x.integer % y.integer;
+    else if (op == '<')
+	computed.integer = x.integer < y.integer;
+    else if (op == '>')
+	computed.integer = x.integer > y.integer;
+    else if (op == LEQ)
+	computed.integer = x.integer <= y.integer;
+    else if (op == GEQ)
+	computed.integer = x.integer >= y.integer;
+    else if (op == EQL)
+	computed.integer = x.integer == y.integer;
+    else if (op == NEQ)
+	computed.integer = x.integer != y.integer;
+    else if (op == AND)
+	computed.integer = x.integer && y.integer;
+    else if (op == OR)
+	computed.integer = x.integer || y.integer;
+    else
+	return false;
+
+    return convert(computed, integer, type, result);
+}
+
+
+/*
+ * Function:	foldSizeOf
+ *
+ * Description:	Compute the size of an OPERAND of the given type under
+ *		the data layout of the current context, and return whether
+ *		it has one that fits in an int.
+ */
+
+bool foldSizeOf(const Type &operand, Constant &result)
+{
+    size_t size = operand.size(context->layout);
+
+
+    if (size == 0 || size > INT_MAX)
+	return false;
+
+    result.integer = size;
+    return true;
 }
 
 //Still off
-Type checkFuncType(const Symbol& sym, Parameters* arguments)
+Type checkFuncType(const Symbol& sym, const Type *arguments, size_t count)
 {
-    cout << "CheckFuncType" << endl;
+    TRACE(CHECKER, "checkFuncType: " << sym.name() << ": " << sym.type());
     if(sym.type().isFunction())
     {
-        Parameters* params = sym.type().parameters();
-        if(params->types.size() > arguments->types.size())
+        const Parameters* params = sym.type().parameters();
+        if(params->types.size() > count)
         { 
-            cout << "E10" << " in first part" << endl;
+            TRACE(CHECKER, "checkFuncType: too few arguments");
             report(E10);
             return error;
         }
-        else if (arguments->types.size() > params->types.size() && !params->variadic)
+        else if (count > params->types.size() && !params->variadic)
         {
-            cout << "E10" << " in variadic part" << endl;
+            TRACE(CHECKER, "checkFuncType: too many arguments");
             report(E10);
             return error;
         }
@@ -507,14 +1034,12 @@ Type checkFuncType(const Symbol& sym, Parameters* arguments)
         {
             for(unsigned i = 0; i < params->types.size(); i++)
             {
-                cout << "pretype" << endl;
-                Type lt = ((arguments->types)[i].promote());
+                Type lt = (arguments[i].promote());
                 Type rt = ((params->types)[i].promote());
 
-                cout << lt << ' ' << rt << endl;
+                TRACE(CHECKER, "checkFuncType: argument " << lt << ", parameter " << rt);
                 if((rt.isCompatibleWith(lt))==false)
                 {
-                    cout << "E10" << endl;
                     report(E10);
                     return error;
                 }
@@ -535,13 +1060,13 @@ Type checkIDType(const Type& left, bool& lvalue)
     
     if(left.isScalar())
     {
-        cout << "CheckIDType" << lvalue << endl;
+        TRACE(CHECKER, "checkIDType: scalar " << left);
         lvalue = true;
         return left;
     }
     else
     {
-        cout << "CheckIDType false" << lvalue << endl;
+        TRACE(CHECKER, "checkIDType: non-scalar " << left);
         lvalue = false;
     }
     return left;
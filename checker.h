@@ -7,15 +7,19 @@
 
 # ifndef CHECKER_H
 # define CHECKER_H
+# include "Arena.h"
 # include "Scope.h"
+# include "Tree.h"
 
 Scope *openScope();
 Scope *closeScope();
+Scope *reopenScope(Scope *scope);
+void allocateFrom(Arena *arena);
 
-Symbol *defineFunction(const std::string &name, const Type &type);
-Symbol *declareFunction(const std::string &name, const Type &type);
-Symbol *declareVariable(const std::string &name, const Type &type);
-Symbol *checkIdentifier(const std::string &name);
+Symbol *defineFunction(Name name, const Type &type);
+Symbol *declareFunction(Name name, const Type &type);
+Symbol *declareVariable(Name name, const Type &type);
+Symbol *checkIdentifier(Name name);
 
 Type checkBreak(int& bcount);
 Type checkReturnType(const Type& left, Symbol& func);
@@ -24,18 +28,24 @@ Type checkAddr(const Type& left, bool& lvalue);
 Type checkAssignment(const Type& left, const Type& right, bool& left_lvalue);
 Type checkIndex(const Type& left, const Type& right);
 Type checkIncDec(bool& lvalue); 
-Type checkDivMul(const Type& left, const Type& right, const std::string &op);
+Type checkDivMul(const Type& left, const Type& right, const char *op);
 Type checkMod(const Type& left, const Type& right);
 Type checkAdd(const Type& left, const Type& right);
 Type checkSub(const Type& left, const Type& right);
-Type checkEQs(const Type& left, const Type& right, const std::string &op);
-Type checkLogical(const Type& left, const Type& right, const std::string &op);
+Type checkEQs(const Type& left, const Type& right, const char *op);
+Type checkLogical(const Type& left, const Type& right, const char *op);
 Type checkNot(const Type& left);
 Type checkNEG(const Type& left);
 Type checkDeref(const Type& left);
 Type checkSizeOf(const Type& left);
 Type checkTypeCast(const Type& left, int typespec, unsigned indirection);
-Type checkFuncType(const Symbol& sym, Parameters* arguments);
+Type checkFuncType(const Symbol& sym, const Type *arguments, size_t count);
 Type checkIDType(const Type& left, bool& lvalue);
 
+bool foldUnary(int op, const Type &type, const Type &operand, Constant value,
+	Constant &result);
+bool foldBinary(int op, const Type &type, const Type &left, Constant x,
+	const Type &right, Constant y, Constant &result);
+bool foldSizeOf(const Type &operand, Constant &result);
+
 # endif /* CHECKER_H */
@@ -0,0 +1,28 @@
+/*
+ * File:	errors.h
+ *
+ * Description:	This file contains the codes for the diagnostics issued by
+ *		the lexer, parser, and checker for Simple C.  A diagnostic
+ *		is reported as a code and an optional argument, and its
+ *		message is only formatted if it is actually written.  The
+ *		zero code means no diagnostic, so a code may be tested
+ *		directly.
+ */
+
+# ifndef ERRORS_H
+# define ERRORS_H
+
+enum Error {
+    NO_ERROR,
+
+    UNTERMINATED_COMMENT, INTEGER_RANGE, REAL_RANGE, STRING_ESCAPE,
+    STRING_ESCAPE_RANGE, CHAR_ESCAPE, CHAR_ESCAPE_RANGE, MULTI_CHAR,
+
+    SYNTAX_ERROR, SYNTAX_ERROR_AT_EOF,
+
+    REDEFINED, REDECLARED, CONFLICTING, UNDECLARED,
+
+    E1, E2, E3, E4, E5, E6, E7, E8, E9, E10
+};
+
+# endif /* ERRORS_H */
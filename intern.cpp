@@ -0,0 +1,61 @@
+/*
+ * File:	intern.cpp
+ *
+ * Description:	This file contains the definitions for the identifier
+ *		table.  The spellings are kept in a deque so that they
+ *		never move, which lets the index refer to them by view
+ *		rather than keeping a second copy of every identifier.
+ *		Each context has a table of its own.
+ */
+
+# include "intern.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+
+/*
+ * Function:	intern
+ *
+ * Description:	Return the name of the given identifier, entering it in
+ *		the table if it has not been seen before.
+ */
+
+Name intern(string_view s)
+{
+    deque<string> &spellings = context->spellings;
+    auto it = context->names.find(s);
+
+
+    if (it != context->names.end())
+	return it->second;
+
+    spellings.emplace_back(s);
+    context->names.emplace(spellings.back(), spellings.size() - 1);
+    return spellings.size() - 1;
+}
+
+
+/*
+ * Function:	spelling
+ *
+ * Description:	Return the identifier with the given name.
+ */
+
+const string &spelling(Name name)
+{
+    return context->spellings[name];
+}
+
+
+/*
+ * Function:	numnames
+ *
+ * Description:	Return the number of distinct identifiers seen so far.
+ *		Names are dense, so every name is less than this number.
+ */
+
+unsigned numnames()
+{
+    return context->spellings.size();
+}
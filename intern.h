@@ -0,0 +1,21 @@
+/*
+ * File:	intern.h
+ *
+ * Description:	This file contains the declarations for the identifier
+ *		table.  Each distinct identifier is stored exactly once and
+ *		is known everywhere else by a dense integer name, so names
+ *		can be compared and hashed as integers.
+ */
+
+# ifndef INTERN_H
+# define INTERN_H
+# include <string>
+# include <string_view>
+
+typedef unsigned Name;
+
+Name intern(std::string_view s);
+const std::string &spelling(Name name);
+unsigned numnames();
+
+# endif /* INTERN_H */
@@ -166,20 +166,7 @@ extern FILE *yyin, *yyout;
 #define EOB_ACT_END_OF_FILE 1
 #define EOB_ACT_LAST_MATCH 2
 
-    /* Note: We specifically omit the test for yy_rule_can_match_eol because it requires
-     *       access to the local variable yy_act. Since yyless() is a macro, it would break
-     *       existing scanners that call yyless() from OUTSIDE yylex. 
-     *       One obvious solution it to make yy_act a global. I tried that, and saw
-     *       a 5% performance hit in a non-yylineno scanner, because yy_act is
-     *       normally declared as a register variable-- so it is not worth it.
-     */
-    #define  YY_LESS_LINENO(n) \
-            do { \
-                int yyl;\
-                for ( yyl = n; yyl < yyleng; ++yyl )\
-                    if ( yytext[yyl] == '\n' )\
-                        --yylineno;\
-            }while(0)
+    #define YY_LESS_LINENO(n)
     
 /* Return all but the first "n" matched characters back to the input stream. */
 #define yyless(n) \
@@ -568,13 +555,6 @@ static yyconst flex_int16_t yy_chk[264] =
       189,  189,  189
     } ;
 
-/* Table of booleans, true if rule could match eol. */
-static yyconst flex_int32_t yy_rule_can_match_eol[53] =
-    {   0,
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0,     };
-
 static yy_state_type yy_last_accepting_state;
 static char *yy_last_accepting_cpos;
 
@@ -595,27 +575,48 @@ char *yytext;
  * File:	lexer.l
  *
  * Description:	This file contains the flex description for the lexical
- *		analyzer for Simple C.
+ *		analyzer for Simple C.  It is the default lexer; scanner.cpp
+ *		is a hand-written alternative with the same interface.
+ *
+ *		Any diagnostic for a token is not reported here but left in
+ *		lexerror for whoever called yylex, so that it can be held
+ *		with the token until the parser reaches it.  Likewise, the
+ *		value of a literal is left in yylval so that it can be held
+ *		with the token and never needs to be parsed again.
+ *
+ *		Lines are not counted here.  Instead, we keep track of the
+ *		offset of each token, which costs one addition per token
+ *		rather than a test of every character, and the line is
+ *		found from the offset only if it is needed.
  *
  *		Extra functionality:
  *		- checking for out of range integer and real literals
  *		- checking for invalid string and character literals
  */
 
-# include <cerrno>
-# include <cstdlib>
-# include <iostream>
-# include "string.h"
+# include <cstdio>
 # include "tokens.h"
 # include "lexer.h"
+# include "source.h"
+# include "trace.h"
+
+# define YY_INPUT(buf, result, max_size) (result = readSource(buf, max_size))
+
+# define YY_USER_ACTION							\
+    yyoffset = consumed;						\
+    consumed += yyleng;							\
+    TRACE(LEXER, "line " << lineOf(yyoffset) << ", column "		\
+	<< columnOf(yyoffset) << ": " << yytext);
+
+# define yyterminate() return (yyoffset = consumed, YY_NULL)
 
 using namespace std;
 
-int numerrors = 0;
-static void checkInt(), checkReal();
-static void checkString(), checkChar();
+size_t yyoffset;
+static size_t consumed;
+
 static void ignoreComment();
-#line 619 "<stdout>"
+#line 620 "<stdout>"
 
 #define INITIAL 0
 
@@ -795,10 +796,10 @@ YY_DECL
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
     
-#line 29 "lexer.l"
+#line 50 "lexer.l"
 
 
-#line 802 "<stdout>"
+#line 803 "<stdout>"
 
 	if ( !(yy_init) )
 		{
@@ -870,16 +871,6 @@ yy_find_action:
 
 		YY_DO_BEFORE_ACTION;
 
-		if ( yy_act != YY_END_OF_BUFFER && yy_rule_can_match_eol[yy_act] )
-			{
-			yy_size_t yyl;
-			for ( yyl = 0; yyl < yyleng; ++yyl )
-				if ( yytext[yyl] == '\n' )
-					   
-    yylineno++;
-;
-			}
-
 do_action:	/* This label is used only to access EOF actions. */
 
 		switch ( yy_act )
@@ -893,266 +884,266 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 31 "lexer.l"
+#line 52 "lexer.l"
 {ignoreComment();}
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 33 "lexer.l"
+#line 54 "lexer.l"
 {return AUTO;}
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 34 "lexer.l"
+#line 55 "lexer.l"
 {return BREAK;}
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 35 "lexer.l"
+#line 56 "lexer.l"
 {return CASE;}
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 36 "lexer.l"
+#line 57 "lexer.l"
 {return CHAR;}
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 37 "lexer.l"
+#line 58 "lexer.l"
 {return CONST;}
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 38 "lexer.l"
+#line 59 "lexer.l"
 {return CONTINUE;}
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 39 "lexer.l"
+#line 60 "lexer.l"
 {return DEFAULT;}
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 40 "lexer.l"
+#line 61 "lexer.l"
 {return DO;}
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 41 "lexer.l"
+#line 62 "lexer.l"
 {return DOUBLE;}
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 42 "lexer.l"
+#line 63 "lexer.l"
 {return ELSE;}
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 43 "lexer.l"
+#line 64 "lexer.l"
 {return ENUM;}
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 44 "lexer.l"
+#line 65 "lexer.l"
 {return EXTERN;}
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 45 "lexer.l"
+#line 66 "lexer.l"
 {return FLOAT;}
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 46 "lexer.l"
+#line 67 "lexer.l"
 {return FOR;}
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 47 "lexer.l"
+#line 68 "lexer.l"
 {return GOTO;}
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 48 "lexer.l"
+#line 69 "lexer.l"
 {return IF;}
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 49 "lexer.l"
+#line 70 "lexer.l"
 {return INT;}
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 50 "lexer.l"
+#line 71 "lexer.l"
 {return LONG;}
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 51 "lexer.l"
+#line 72 "lexer.l"
 {return REGISTER;}
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 52 "lexer.l"
+#line 73 "lexer.l"
 {return RETURN;}
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 53 "lexer.l"
+#line 74 "lexer.l"
 {return SHORT;}
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 54 "lexer.l"
+#line 75 "lexer.l"
 {return SIGNED;}
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 55 "lexer.l"
+#line 76 "lexer.l"
 {return SIZEOF;}
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 56 "lexer.l"
+#line 77 "lexer.l"
 {return STATIC;}
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 57 "lexer.l"
+#line 78 "lexer.l"
 {return STRUCT;}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 58 "lexer.l"
+#line 79 "lexer.l"
 {return SWITCH;}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 59 "lexer.l"
+#line 80 "lexer.l"
 {return TYPEDEF;}
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 60 "lexer.l"
+#line 81 "lexer.l"
 {return UNION;}
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 61 "lexer.l"
+#line 82 "lexer.l"
 {return UNSIGNED;}
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 62 "lexer.l"
+#line 83 "lexer.l"
 {return VOID;}
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 63 "lexer.l"
+#line 84 "lexer.l"
 {return VOLATILE;}
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 64 "lexer.l"
+#line 85 "lexer.l"
 {return WHILE;}
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 66 "lexer.l"
+#line 87 "lexer.l"
 {return OR;}
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 67 "lexer.l"
+#line 88 "lexer.l"
 {return AND;}
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 68 "lexer.l"
+#line 89 "lexer.l"
 {return EQL;}
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 69 "lexer.l"
+#line 90 "lexer.l"
 {return NEQ;}
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 70 "lexer.l"
+#line 91 "lexer.l"
 {return LEQ;}
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 71 "lexer.l"
+#line 92 "lexer.l"
 {return GEQ;}
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 72 "lexer.l"
+#line 93 "lexer.l"
 {return INC;}
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 73 "lexer.l"
+#line 94 "lexer.l"
 {return DEC;}
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 74 "lexer.l"
+#line 95 "lexer.l"
 {return ARROW;}
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 75 "lexer.l"
+#line 96 "lexer.l"
 {return ELLIPSIS;}
 	YY_BREAK
 case 44:
 YY_RULE_SETUP
-#line 76 "lexer.l"
+#line 97 "lexer.l"
 {return *yytext;}
 	YY_BREAK
 case 45:
 YY_RULE_SETUP
-#line 78 "lexer.l"
+#line 99 "lexer.l"
 {return ID;}
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 80 "lexer.l"
+#line 101 "lexer.l"
 {checkInt(); return INTEGER;}
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 81 "lexer.l"
+#line 102 "lexer.l"
 {checkReal(); return REAL;}
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 82 "lexer.l"
+#line 103 "lexer.l"
 {checkString(); return STRING;}
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 83 "lexer.l"
+#line 104 "lexer.l"
 {checkChar(); return CHARACTER;}
 	YY_BREAK
 case 50:
 /* rule 50 can match eol */
 YY_RULE_SETUP
-#line 85 "lexer.l"
+#line 106 "lexer.l"
 {/* ignored */}
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 86 "lexer.l"
+#line 107 "lexer.l"
 {/* ignored */}
 	YY_BREAK
 case 52:
 YY_RULE_SETUP
-#line 88 "lexer.l"
+#line 109 "lexer.l"
 ECHO;
 	YY_BREAK
-#line 1156 "<stdout>"
+#line 1147 "<stdout>"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1551,11 +1542,6 @@ static int yy_get_next_buffer (void)
 	*(yy_c_buf_p) = '\0';	/* preserve yytext */
 	(yy_hold_char) = *++(yy_c_buf_p);
 
-	if ( c == '\n' )
-		   
-    yylineno++;
-;
-
 	return c;
 }
 #endif	/* ifndef YY_NO_INPUT */
@@ -2022,9 +2008,6 @@ static int yy_init_globals (void)
      * This function is called from yylex_destroy(), so don't allocate here.
      */
 
-    /* We do not touch yylineno unless the option is enabled. */
-    yylineno =  1;
-    
     (yy_buffer_stack) = 0;
     (yy_buffer_stack_top) = 0;
     (yy_buffer_stack_max) = 0;
@@ -2117,131 +2100,80 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 88 "lexer.l"
+#line 109 "lexer.l"
 
 
 
 /*
- * Function:	ignoreComment
+ * Function:	nextChar
  *
- * Description:	Ignore a comment after recognizing its beginning.
+ * Description:	Read the next character of a comment.  A mapped buffer
+ *		cannot be refilled, and yyinput would try to restart it
+ *		from a nonexistent input file at its end, so we report the
+ *		end of file ourselves.
  */
 
-static void ignoreComment()
+static int nextChar()
 {
-    int c1, c2;
+    int c;
 
 
-    while ((c1 = yyinput()) != 0) {
-	while (c1 == '*') {
-	    if ((c2 = yyinput()) == '/' || c2 == 0)
-		return;
+    if (!YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer)
+	if (yy_c_buf_p >= YY_CURRENT_BUFFER_LVALUE->yy_ch_buf + yy_n_chars)
+	    return EOF;
 
-	    c1 = c2;
-	}
-    }
+    if ((c = yyinput()) != EOF)
+	consumed ++;
 
-    if (c1 == 0)
-	report("unterminated comment");
+    return c;
 }
 
 
 /*
- * Function:	checkInt
- *
- * Description:	Check if an integer constant is valid.
- */
-
-static void checkInt()
-{
-    long val;
-
-
-    errno = 0;
-    val = strtol(yytext, NULL, 0);
-
-    if (errno != 0 || val != (int) val)
-	report("integer constant too large");
-}
-
-
-/*
- * Function:	checkReal
+ * Function:	ignoreComment
  *
- * Description:	Check if a floating-point constant is valid.
+ * Description:	Ignore a comment after recognizing its beginning.
  */
 
-static void checkReal()
+static void ignoreComment()
 {
-    errno = 0;
-    strtod(yytext, NULL);
-
-    if (errno != 0)
-	report("floating-point constant out of range");
-}
-
-
-/*
- * Function:	checkString
- *
- * Description:	Check if a string literal is valid.
- */
+    int c1, c2;
 
-static void checkString()
-{
-    bool invalid, overflow;
-    string s(yytext + 1, yyleng - 2);
 
+    while ((c1 = nextChar()) != 0 && c1 != EOF) {
+	while (c1 == '*') {
+	    if ((c2 = nextChar()) == '/' || c2 == 0 || c2 == EOF)
+		return;
 
-    s = parseString(s, invalid, overflow);
+	    c1 = c2;
+	}
+    }
 
-    if (invalid)
-	report("unknown escape sequence in string constant");
-    else if (overflow)
-	report("escape sequence out of range in string constant");
+    lexerror = UNTERMINATED_COMMENT;
 }
 
 
 /*
- * Function:	checkChar
+ * Function:	scanBuffer
  *
- * Description:	Check if a character literal is valid.
+ * Description:	Scan the given buffer in place.  The buffer must end with
+ *		two null characters, which are not included in the size.
  */
 
-static void checkChar()
+void scanBuffer(char *buf, size_t size)
 {
-    bool invalid, overflow;
-    string s(yytext + 1, yyleng - 2);
-
-
-    s = parseString(s, invalid, overflow);
-
-    if (invalid)
-	report("unknown escape sequence in character constant");
-    else if (overflow)
-	report("escape sequence out of range in character constant");
-    else if (s.size() > 1)
-	report("multi-character character constant");
+    yy_scan_buffer(buf, size + 2);
 }
 
 
 /*
- * Function:	report
+ * Function:	scanStream
  *
- * Description:	Report an error to the standard error prefixed with the
- *		line number.  We'll be using this a lot later with an
- *		optional string argument, but C++'s stupid streams don't do
- *		positional arguments, so we actually resort to snprintf.
- *		You just can't beat C for doing things down and dirty.
+ * Description:	Scan the source by reading it in chunks.  Flex does this
+ *		by itself through YY_INPUT once there is no buffer to scan.
  */
 
-void report(const string &str, const string &arg)
+void scanStream()
 {
-    char buf[1000];
-
-
-    snprintf(buf, sizeof(buf), str.c_str(), arg.c_str());
-    cerr << "line " << yylineno << ": " << buf << endl;
-    numerrors ++;
 }
 
@@ -2,17 +2,40 @@
  * File:	lexer.h
  *
  * Description:	This file contains the public function and variable
- *		declarations for the lexical analyzer for Simple C.
+ *		declarations for the lexical analyzer for Simple C.  Either
+ *		lexer may be linked in, and both provide these.  Along with
+ *		its text, each token has its offset in the source in
+ *		yyoffset, from which its line can be found when needed.
  */
 
 # ifndef LEXER_H
 # define LEXER_H
+# include <cstddef>
 # include <string>
+# include <string_view>
+# include "errors.h"
 
 extern char *yytext;
-extern int yylineno, numerrors;
+extern size_t yyleng, yyoffset;
+extern Error lexerror;
+
+extern struct Literal {
+    unsigned long integer;
+    double real;
+    std::string chars;
+} yylval;
 
 extern int yylex();
-extern void report(const std::string &str, const std::string &arg = "");
+extern void scanBuffer(char *buf, size_t size);
+extern void scanStream();
+
+extern void checkInt(), checkReal();
+extern void checkString(), checkChar();
+
+extern Error checkInt(std::string_view text, Literal &value);
+extern Error checkReal(std::string_view text, Literal &value);
+extern Error checkString(std::string_view text, Literal &value);
+extern Error checkChar(std::string_view text, Literal &value);
+extern Error checkLiteral(int kind, std::string_view text, Literal &value);
 
 # endif /* LEXER_H */
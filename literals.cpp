@@ -0,0 +1,208 @@
+/*
+ * File:	literals.cpp
+ *
+ * Description:	This file contains the function and variable definitions
+ *		for checking the literals recognized by the lexer.  They are
+ *		shared by both lexers.
+ *
+ *		Each check is given the text of a literal and computes its
+ *		value, returning any diagnostic for it rather than reporting
+ *		it, and touches nothing else, so literals may be checked on
+ *		several threads at once.  The flex lexer uses the versions
+ *		taking no arguments, which check yytext and leave the value
+ *		in yylval and the diagnostic in lexerror.
+ */
+
+# include <cerrno>
+# include <climits>
+# include <cstdlib>
+# include <cstring>
+# include "string.h"
+# include "tokens.h"
+# include "lexer.h"
+
+using namespace std;
+
+Error lexerror = NO_ERROR;
+Literal yylval;
+
+
+/*
+ * Function:	checkInt
+ *
+ * Description:	Check if an integer constant is valid and compute its
+ *		value.  As with strtol, a leading zero means octal and the
+ *		digits end at the first one not valid in the base.  The
+ *		value saturates on overflow, as it would with strtoul.
+ */
+
+Error checkInt(string_view text, Literal &value)
+{
+    unsigned long val, base, digit;
+
+
+    val = 0;
+    base = text[0] == '0' ? 8 : 10;
+
+    for (char c : text) {
+	if (c < '0' || c >= (int) ('0' + base))
+	    break;
+
+	digit = c - '0';
+
+	if (val > (ULONG_MAX - digit) / base)
+	    val = ULONG_MAX;
+	else
+	    val = val * base + digit;
+    }
+
+    value.integer = val;
+    return val > INT_MAX ? INTEGER_RANGE : NO_ERROR;
+}
+
+
+/*
+ * Function:	checkReal
+ *
+ * Description:	Check if a floating-point constant is valid.  Since the
+ *		text need not be terminated, it is first copied, into a
+ *		small buffer if it fits.
+ */
+
+Error checkReal(string_view text, Literal &value)
+{
+    char buf[64];
+    string copy;
+    const char *s;
+
+
+    if (text.size() < sizeof(buf)) {
+	memcpy(buf, text.data(), text.size());
+	buf[text.size()] = '\0';
+	s = buf;
+    } else {
+	copy = text;
+	s = copy.c_str();
+    }
+
+    errno = 0;
+    value.real = strtod(s, NULL);
+    return errno != 0 ? REAL_RANGE : NO_ERROR;
+}
+
+
+/*
+ * Function:	checkString
+ *
+ * Description:	Check if a string literal is valid and decode it.
+ */
+
+Error checkString(string_view text, Literal &value)
+{
+    bool invalid, overflow;
+
+
+    value.chars.clear();
+    parseString(text.substr(1, text.size() - 2), value.chars,
+		invalid, overflow);
+
+    if (invalid)
+	return STRING_ESCAPE;
+
+    if (overflow)
+	return STRING_ESCAPE_RANGE;
+
+    return NO_ERROR;
+}
+
+
+/*
+ * Function:	checkChar
+ *
+ * Description:	Check if a character literal is valid and compute its
+ *		value, which is that of its first character as a char.
+ */
+
+Error checkChar(string_view text, Literal &value)
+{
+    bool invalid, overflow;
+    string &s = value.chars;
+
+
+    s.clear();
+    parseString(text.substr(1, text.size() - 2), s, invalid, overflow);
+    value.integer = (long) (char) s[0];
+
+    if (invalid)
+	return CHAR_ESCAPE;
+
+    if (overflow)
+	return CHAR_ESCAPE_RANGE;
+
+    if (s.size() > 1)
+	return MULTI_CHAR;
+
+    return NO_ERROR;
+}
+
+
+/*
+ * Function:	checkLiteral
+ *
+ * Description:	Check the given token if it is a literal, returning any
+ *		diagnostic for it.
+ */
+
+Error checkLiteral(int kind, string_view text, Literal &value)
+{
+    if (kind == INTEGER)
+	return checkInt(text, value);
+
+    if (kind == REAL)
+	return checkReal(text, value);
+
+    if (kind == STRING)
+	return checkString(text, value);
+
+    if (kind == CHARACTER)
+	return checkChar(text, value);
+
+    return NO_ERROR;
+}
+
+
+/*
+ * Function:	check
+ *
+ * Description:	Check yytext as the given kind of literal for the flex
+ *		lexer, leaving any diagnostic in lexerror.
+ */
+
+static void check(int kind)
+{
+    Error error;
+
+
+    if ((error = checkLiteral(kind, string_view(yytext, yyleng), yylval)))
+	lexerror = error;
+}
+
+void checkInt()
+{
+    check(INTEGER);
+}
+
+void checkReal()
+{
+    check(REAL);
+}
+
+void checkString()
+{
+    check(STRING);
+}
+
+void checkChar()
+{
+    check(CHARACTER);
+}
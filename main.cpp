@@ -0,0 +1,96 @@
+/*
+ * File:	main.cpp
+ *
+ * Description:	This file contains the main program for the compiler,
+ *		which checks a single source file named on the command line
+ *		or read from the standard input.  Its context is a global,
+ *		so that its diagnostics are written out on exit no matter
+ *		how we got there.
+ */
+
+# include <algorithm>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include "parser.h"
+# include "source.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+static CompilerContext unit;
+
+static void stopLexer()
+{
+    unit.tokens.stop();
+}
+
+
+/*
+ * Function:	stop
+ *
+ * Description:	Exit unsuccessfully, reporting the error that stopped the
+ *		unit if it was stopped by one.  Any diagnostics already
+ *		reported are written out first.
+ */
+
+static void stop()
+{
+    if (unit.error != 0) {
+	unit.diagnostics.flush();
+	fprintf(stderr, "%s: %s\n", unit.name, strerror(unit.error));
+    }
+
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = nullptr;
+    bool pipelined = false;
+    unsigned threads = 1, checkers = 1;
+
+    context = &unit;
+
+    for (int i = 1; i < argc; i ++)
+	if (strcmp(argv[i], "-fpipeline") == 0)
+	    pipelined = true;
+	else if (strncmp(argv[i], "-flex-threads=", 14) == 0)
+	    threads = max(atoi(argv[i] + 14), 1);
+	else if (strncmp(argv[i], "-fcheck-threads=", 16) == 0)
+	    checkers = max(atoi(argv[i] + 16), 1);
+	else if (strncmp(argv[i], "-ferror-limit=", 14) == 0)
+	    unit.diagnostics.limit(max(atoi(argv[i] + 14), 0));
+	else if (strcmp(argv[i], "-fdedup-errors") == 0)
+	    unit.diagnostics.deduplicate(true);
+	else if (strcmp(argv[i], "-fdiagnostics-format=json") == 0)
+	    unit.diagnostics.format(Diagnostics::JSON);
+	else if (strcmp(argv[i], "-fdiagnostics-format=text") == 0)
+	    unit.diagnostics.format(Diagnostics::TEXT);
+	else if (strcmp(argv[i], "-fstream") == 0)
+	    unit.streaming = true;
+	else if (strcmp(argv[i], "-m32") == 0)
+	    unit.layout = ILP32;
+	else if (strcmp(argv[i], "-m64") == 0)
+	    unit.layout = LP64;
+	else if (filename == nullptr)
+	    filename = argv[i];
+
+    openSource(filename, threads);
+
+    if (unit.stopped)
+	stop();
+
+    if (unit.source != nullptr && threads > 1)
+	unit.tokens.readAll(threads);
+    else if (pipelined) {
+	unit.tokens.pipeline();
+	atexit(stopLexer);
+    } else if (unit.source != nullptr)
+	unit.tokens.readAll();
+
+    if (!parse(checkers) || unit.stopped)
+	stop();
+
+    exit(EXIT_SUCCESS);
+}
@@ -1,83 +1,175 @@
-# include <cstdlib>
-# include <iostream>
+# include <algorithm>
+# include <atomic>
+# include <mutex>
+# include <thread>
+# include <vector>
 # include "checker.h"
+# include "parser.h"
 # include "tokens.h"
 # include "lexer.h"
+# include "source.h"
+# include "trace.h"
+# include "CompilerContext.h"
 
 using namespace std;
 
-static Type expression(bool& lvalue);
-static void statement(Symbol& function);
+static Node statement(Symbol& function);
 
-static int lookahead, nexttoken;
-static string lexbuf, nextbuf;
-int bcount = 0;
+static thread_local Tree *tree;
+static thread_local unsigned current, reached;
+static thread_local int lookahead;
+static thread_local bool panicking, failed;
+static thread_local unsigned quiet;
+static thread_local Arena locals;
+thread_local int bcount = 0;
+
+static int token(unsigned i);
+
+
+/*
+ * Panic-mode recovery: on a syntax error we skip to the next token that
+ * can follow a declaration or statement, namely a semicolon, closing
+ * brace, or specifier starting a declaration, and until the parser has
+ * resumed there all other matches do nothing and each expression is of
+ * the error type, so that the constructs in progress finish without
+ * consuming anything or reporting anything more.  As in yacc, further
+ * syntax errors are not reported until a few tokens have been matched
+ * after resuming, since they are usually caused by the first one.
+ */
+
+enum { QUIET = 3 };
+
+static bool isSpecifier(int token)
+{
+    return token == CHAR || token == INT || token == DOUBLE;
+}
+
+static bool synchronizes(int token)
+{
+    if (token == ';' || token == '}' || token == DONE)
+	return true;
+
+    return isSpecifier(token)
+	&& (current == 0 || context->tokens.kind(current - 1) != '(');
+}
 
 static void error()
 {
-    if (lookahead == DONE)
-	report("syntax error at end of file");
-    else
-	report("syntax error at '%s'", yytext);
+    if (quiet == 0) {
+	if (lookahead == DONE)
+	    report(SYNTAX_ERROR_AT_EOF);
+	else
+	    report(SYNTAX_ERROR, context->tokens.text(current));
+    }
 
-    exit(EXIT_FAILURE);
+    panicking = failed = true;
+    quiet = QUIET;
+
+    while (!synchronizes(lookahead))
+	lookahead = token(++ current);
 }
 
-static int peek()
+/*
+ * Function:	token
+ *
+ * Description:	Return the kind of the token at the given index, reading
+ *		from the lexer if it has not yet been read.  When a token
+ *		is reached for the first time, any diagnostic the lexer
+ *		issued for it is reported, and the position is updated so
+ *		that later diagnostics are reported on its line.  Once the
+ *		context has stopped, every token is the end of file.
+ */
+
+static int token(unsigned i)
 {
-    if (nexttoken == 0) {
-	nexttoken = yylex();
-	nextbuf = yytext;
+    Error message;
+
+
+    if (context->stopped)
+	return DONE;
+
+    while (context->tokens.size() <= i && !context->tokens.done())
+	context->tokens.read();
+
+    if (i >= context->tokens.size())
+	i = context->tokens.size() - 1;
+
+    while (reached <= i) {
+	position = context->tokens.position(reached);
+
+	if ((message = context->tokens.message(reached)))
+	    report(message);
+
+	reached ++;
     }
 
-    return nexttoken;
+    return context->tokens.kind(i);
+}
+
+static int peek()
+{
+    return token(current + 1);
 }
 
 static void match(int t)
 {
-    if (lookahead != t)
-	error();
+    if (panicking)
+	return;
 
-    if (nexttoken != 0) {
-	lookahead = nexttoken;
-	lexbuf = nextbuf;
-	nexttoken = 0;
-    } else {
-	lookahead = yylex();
-	lexbuf = yytext;
+    if (lookahead != t) {
+	error();
+	return;
     }
+
+    if (quiet > 0)
+	quiet --;
+
+    lookahead = token(++ current);
+}
+
+static void resume(int t)
+{
+    panicking = false;
+
+    if (lookahead == t)
+	match(t);
 }
 
 static unsigned integer()
 {
-    string buf;
-    buf = lexbuf;
     match(INTEGER);
-    return strtoul(buf.c_str(), NULL, 0);
+    return panicking ? 0 : context->tokens.integer(current - 1);
 }
 
-static string identifier()
+static Name identifier()
 {
-    string buf;
-    buf = lexbuf;
     match(ID);
-    return buf;
+    return panicking ? 0 : context->tokens.name(current - 1);
 }
 
-static void closeParamScope()
+/*
+ * Function:	release
+ *
+ * Description:	Release the given scope once it has been closed.  Only the
+ *		outermost scope and its symbols are on the heap.  Any other
+ *		scope is in the arena of its function, and need only be
+ *		destroyed, since its symbols have nothing to destroy.
+ */
+
+static void release(Scope *scope)
 {
-    Scope *scope;
-    scope = closeScope();
+    static_assert(is_trivially_destructible<Symbol>::value);
+
+    if (scope->enclosing() != nullptr) {
+	scope->~Scope();
+	return;
+    }
+
     for (auto symbol : scope->symbols())
 	delete symbol;
     delete scope;
 }
 
-static bool isSpecifier(int token)
-{
-    return token == CHAR || token == INT || token == DOUBLE;
-}
-
 static int specifier()
 {
     int typespec = ERROR;
@@ -105,17 +197,19 @@ static unsigned pointers()
 
 static void declarator(int typespec)
 {
-    unsigned indirection;
-    string name;
+    unsigned indirection, length;
+    Name name;
     indirection = pointers();
     name = identifier();
     if (lookahead == '[') 
 	{
 		match('[');
-		declareVariable(name, Type(typespec, indirection, integer()));
+		length = integer();
+		if (!panicking)
+			declareVariable(name, Type(typespec, indirection, length));
 		match(']');
     } 
-	else
+	else if (!panicking)
 		declareVariable(name, Type(typespec, indirection));
 }
 
@@ -131,6 +225,9 @@ static void declaration()
     }
 
     match(';');
+
+    if (panicking)
+	resume(';');
 }
 
 static void declarations()
@@ -139,473 +236,703 @@ static void declarations()
 		declaration();
 }
 
-// Definitely needs to be checked
-static Type primaryExpression(bool& lvalue)
+/*
+ * The binary operators, with their precedences and checks.  All of them
+ * are left associative, and a higher precedence binds more tightly.
+ */
+
+static const struct Operator {
+    int token;
+    unsigned precedence;
+    const char *spelling;
+    Type (*check)(const Type &left, const Type &right, const char *op);
+} operators[] = {
+    {OR, 1, "||", checkLogical},
+    {AND, 2, "&&", checkLogical},
+    {EQL, 3, "==", checkEQs},
+    {NEQ, 3, "!=", checkEQs},
+    {LEQ, 4, "<=", checkEQs},
+    {GEQ, 4, ">=", checkEQs},
+    {'<', 4, "<", checkEQs},
+    {'>', 4, ">", checkEQs},
+    {'+', 5, "+", [](const Type &left, const Type &right, const char *)
+	{ return checkAdd(left, right); }},
+    {'-', 5, "-", [](const Type &left, const Type &right, const char *)
+	{ return checkSub(left, right); }},
+    {'*', 6, "*", checkDivMul},
+    {'/', 6, "/", checkDivMul},
+    {'%', 6, "%", [](const Type &left, const Type &right, const char *)
+	{ return checkMod(left, right); }},
+};
+
+static const Operator *binaryOperator(int token)
 {
-	cout << "primaryExpression() lvalue: " << lvalue << endl;
-	Type left;
-	Type right; 
-	Symbol *sym;
+    static const vector<const Operator *> table = [] {
+	vector<const Operator *> table(CHARACTER + 1);
+
+	for (auto &op : operators)
+	    table[op.token] = &op;
+
+	return table;
+    }();
 
-    if (lookahead == '(') 
+    return token >= 0 && token <= CHARACTER ? table[token] : nullptr;
+}
+
+
+/*
+ * Function:	append
+ *
+ * Description:	Append the given node, if any, to the list of nodes with
+ *		the given head and tail.
+ */
+
+static void append(Node &head, Node &tail, Node node)
+{
+	if (node == 0)
+		return;
+
+	if (head == 0)
+		head = node;
+	else
+		tree->link(tail, node);
+
+	tail = node;
+}
+
+
+/*
+ * An expression is parsed without recursion, using an explicit stack of
+ * the operations still waiting for an operand.  A unary operator waits
+ * for its operand, a binary operator for its right operand, and a
+ * parenthesis, subscript, or call for the expression inside it, which
+ * is parsed above it on the same stack.  The unary operators, subscripts,
+ * and calls use their node kinds.  The arguments of the calls are kept on
+ * a stack of their own, each call knowing where its arguments start, so
+ * that a call allocates nothing once the stack is large enough.
+ */
+
+enum { PAREN = 1, BINARY };
+
+struct Pending {
+    int kind;
+    unsigned token;
+    Type left;
+    Node node, last;
+    const Operator *op;
+    Symbol *symbol;
+    size_t args;
+    int typespec;
+    unsigned indirection;
+};
+
+static thread_local vector<Pending> pending;
+static thread_local vector<Type> arguments;
+
+
+/*
+ * Function:	reduce
+ *
+ * Description:	Check the pending binary operators whose precedence is at
+ *		least the given precedence, combining the given right
+ *		operand with each left operand in turn.
+ */
+
+static Type reduce(Type right, bool& lvalue, Node& node, size_t base,
+	unsigned precedence)
+{
+	Constant value;
+	Type result;
+	bool folded;
+
+	while (pending.size() > base && pending.back().kind == BINARY
+		&& pending.back().op->precedence >= precedence)
+	{
+		const Pending &top = pending.back();
+		result = top.op->check(top.left, right, top.op->spelling);
+		folded = tree->constant(top.node) && tree->constant(node)
+			&& foldBinary(top.op->token, result,
+				top.left, tree->value(top.node),
+				right, tree->value(node), value);
+		lvalue = false;
+		tree->link(top.node, node);
+		node = tree->add(top.op->token, top.token, result, false,
+			top.node);
+
+		if (folded)
+			tree->fold(node, value);
+
+		right = result;
+		pending.pop_back();
+	}
+
+	return right;
+}
+
+
+/*
+ * Function:	expression
+ *
+ * Description:	Parse and check an expression, leaving its tree in NODE.
+ *		We start each operand by pushing its prefix operators, and
+ *		then parse its primary expression and any postfix
+ *		operators, starting a new expression for a parenthesis,
+ *		subscript, or argument.  Once an operand is complete, we
+ *		apply its prefix operators, and on reaching a binary
+ *		operator we check the pending binary operators that bind at
+ *		least as tightly, exactly as a recursive parser would return
+ *		from each level of precedence.  The checks thus occur in the
+ *		same order as in the grammar, however deeply the expression
+ *		is nested.  After a syntax error, the operations still
+ *		pending are discarded unchecked and the expression is of the
+ *		error type.
+ */
+
+static Type expression(bool& lvalue, Node& node)
+{
+	size_t base = pending.size();
+	const Operator *op;
+	Constant value;
+	Pending top;
+	Type left, operand;
+	Node child;
+	Name name;
+
+operand:
+	while (1)
+	{
+		if (panicking)
+			goto unwind;
+
+		TRACE(PARSER, "prefixExpression: line " << context->tokens.line(current));
+		top.token = current;
+
+		if (lookahead == '-')
+			top.kind = NEGATE;
+		else if (lookahead == '!')
+			top.kind = LOGICAL_NOT;
+		else if (lookahead == '&')
+			top.kind = ADDRESS_OF;
+		else if (lookahead == '*')
+			top.kind = DEREF;
+		else if (lookahead == SIZEOF)
+		{
+			match(SIZEOF);
+
+			if (lookahead == '(' && isSpecifier(peek()))
+			{
+				match('(');
+				top.typespec = specifier();
+				top.indirection = pointers();
+				match(')');
+				operand = Type(top.typespec, top.indirection);
+				left = checkSizeOf(operand);
+				lvalue = false;
+				node = tree->add(SIZE_OF, top.token, left);
+
+				if (foldSizeOf(operand, value))
+					tree->fold(node, value);
+
+				goto unary;
+			}
+
+			top.kind = SIZE_OF;
+			pending.push_back(top);
+			continue;
+		}
+		else if (lookahead == '(' && isSpecifier(peek()))
+		{
+			match('(');
+			top.kind = CAST;
+			top.typespec = specifier();
+			top.indirection = pointers();
+			match(')');
+			pending.push_back(top);
+			continue;
+		}
+		else
+			break;
+
+		pending.push_back(top);
+		match(lookahead);
+	}
+
+	TRACE(PARSER, "primaryExpression: line " << context->tokens.line(current));
+	top.token = current;
+
+	if (lookahead == '(')
 	{
 		match('(');
-		left = expression(lvalue);
-		match(')');
+		top.kind = PAREN;
+		pending.push_back(top);
+		goto operand;
 	}
-	else if (lookahead == CHARACTER) 
+	else if (lookahead == CHARACTER)
 	{
 		match(CHARACTER);
 		left = Type(INT);
 		lvalue = false;
-    } 
-	else if (lookahead == STRING) 
+		node = tree->add(CHARACTER, top.token, left);
+		value.integer = context->tokens.integer(top.token);
+		tree->fold(node, value);
+	}
+	else if (lookahead == STRING)
 	{
+		left = Type(CHAR, 0, context->tokens.chars(current).length() + 1);
 		match(STRING);
-		left = Type(CHAR, 0, lexbuf.length()-2);
 		lvalue = false;
-    } 
-	else if (lookahead == INTEGER) 
+		node = tree->add(STRING, top.token, left);
+	}
+	else if (lookahead == INTEGER)
 	{
 		match(INTEGER);
 		left = Type(INT);
 		lvalue = false;
-    } 
-	else if (lookahead == REAL) 
+		node = tree->add(INTEGER, top.token, left);
+		value.integer = context->tokens.integer(top.token);
+		tree->fold(node, value);
+	}
+	else if (lookahead == REAL)
 	{
 		match(REAL);
 		left = Type(DOUBLE);
 		lvalue = false;
-    } 
-	else if (lookahead == ID) 
-	{
-		string name = identifier();
-		bool tempLval;
-		Parameters* args = new Parameters();
-		sym = checkIdentifier(name);
-		lvalue = sym->type().isScalar();
-		left = checkIDType(sym->type(), lvalue);
-		if (lookahead == '(') 
+		node = tree->add(REAL, top.token, left);
+		value.real = context->tokens.real(top.token);
+		tree->fold(node, value);
+	}
+	else if (lookahead == ID)
+	{
+		name = identifier();
+		top.kind = CALL;
+		top.symbol = checkIdentifier(name);
+		lvalue = top.symbol->type().isScalar();
+		left = checkIDType(top.symbol->type(), lvalue);
+		node = tree->add(ID, top.token, left, lvalue);
+
+		if (lookahead == '(')
 		{
 			match('(');
-			if (lookahead != ')') 
-			{
-				Type tempT;
-				tempT = expression(tempLval);
-				args->types.push_back(tempT); //should I implement explist outside?
-				while (lookahead == ',') 
-				{
-					match(',');
-					tempT = expression(tempLval);
-					args->types.push_back(tempT);
-				}
-			}
-			cout << sym << " " << args << endl;
-			match(')');
-			left = checkFuncType(*sym, args);
-			lvalue = false;
+			top.args = arguments.size();
+			top.node = top.last = node;
+			pending.push_back(top);
+
+			if (lookahead != ')')
+				goto operand;
+
+			goto call;
 		}
-    } 
+	}
 	else
 		error();
 
-	return left;
-}
+postfix:
+	if (panicking)
+		goto unwind;
 
-static Type postfixExpression(bool& lvalue)
-{
-    Type left = primaryExpression(lvalue);
-    Type right;
-	cout << "postfixExpression lvalue:" << lvalue << endl;
+	TRACE(PARSER, "postfixExpression: " << left << (lvalue ? " lvalue" : ""));
 
-    while (1) 
+	while (1)
 	{
-		if (lookahead == '[') 
+		top.token = current;
+
+		if (lookahead == '[')
 		{
 			match('[');
-			right = expression(lvalue);
-			left = checkIndex(left, right);
-			cout << "Postfix brack in parser" << lvalue << endl;
-			lvalue = true;
-			match(']');
-		} 
-		else if (lookahead == INC) 
+			top.kind = INDEX;
+			top.left = left;
+			top.node = node;
+			pending.push_back(top);
+			goto operand;
+		}
+		else if (lookahead == INC)
 		{
 			match(INC);
-			cout << "Postfix Inc in parser" << lvalue << endl;
-			checkIncDec(lvalue); 
+			checkIncDec(lvalue);
 			lvalue = false;
-		} 
-		else if (lookahead == DEC) 
+			node = tree->add(POSTINC, top.token, left, false, node);
+		}
+		else if (lookahead == DEC)
 		{
 			match(DEC);
-			cout << "Postfix Dec in parser" << lvalue << endl;
-			checkIncDec(lvalue); 
+			checkIncDec(lvalue);
 			lvalue = false;
-		} 
+			node = tree->add(POSTDEC, top.token, left, false, node);
+		}
 		else
 			break;
-    }
-	return left;
-}
+	}
 
-static Type prefixExpression(bool& lvalue)
-{
-	cout << "enter prefix" << lvalue << endl;
-	Type left;
-	if (lookahead == '-') 
-	{
-		match('-');
-		left = prefixExpression(lvalue);
-		left = checkNEG(left);
-		lvalue = false;
-    } 
-    else if (lookahead == '!') 
-	{
-		match('!');
-		left = prefixExpression(lvalue);
-		left = checkNot(left);
-		lvalue = false;
-    } 
-	else if (lookahead == '&') 
-	{
-		match('&');
-		cout << "prefix & before" << lvalue << endl;
-		left = prefixExpression(lvalue);
-		cout << "prefix & after" << lvalue << endl;
-		left = checkAddr(left, lvalue);
-		lvalue = false;
-    } 
-	else if (lookahead == '*') 
-	{
-		match('*');
-		left = prefixExpression(lvalue);
-		left = checkDeref(left);
-		cout << "Prefix * in parser" << lvalue << endl;
-		lvalue = true;
-    } 
-	else if (lookahead == SIZEOF) 
+	left = left.promote();
+
+unary:
+	if (panicking)
+		goto unwind;
+
+	while (pending.size() > base && pending.back().kind >= NEGATE
+		&& pending.back().kind <= CAST)
 	{
-		match(SIZEOF);
+		top = pending.back();
+		pending.pop_back();
+		operand = left;
+		child = node;
 
-		if (lookahead == '(' && isSpecifier(peek())) 
-		{
-			match('(');
-			specifier();
-			pointers();
-			match(')');
-		} 
-		else 
+		if (top.kind == NEGATE)
 		{
-			left = prefixExpression(lvalue);
+			left = checkNEG(left);
+			lvalue = false;
 		}
-		left = checkSizeOf(left);
-		lvalue = false;
-    } 
-	else if (lookahead == '(' && isSpecifier(peek())) 
-	{
-		match('(');
-		int typespec = specifier();
-		unsigned indirection = pointers();
-		match(')');
-		left = prefixExpression(lvalue);
-		left = checkTypeCast(left, typespec, indirection);
-		lvalue = false;
-    } 
-	else
-	{
-		left = postfixExpression(lvalue);
-		left = left.promote();
-	}
-	return left;
-}
-
-static Type multiplicativeExpression(bool& lvalue)
-{
-    Type left = prefixExpression(lvalue);
-    Type right;
-
-    while (1) 
-	{
-		if (lookahead == '*') 
+		else if (top.kind == LOGICAL_NOT)
 		{
-			match('*');
-			right = prefixExpression(lvalue);
-			left = checkDivMul(left, right, "*");
+			left = checkNot(left);
 			lvalue = false;
-		} 
-		else if (lookahead == '/') 
+		}
+		else if (top.kind == ADDRESS_OF)
 		{
-			match('/');
-			right = prefixExpression(lvalue);
-			left = checkDivMul(left, right, "/");
+			TRACE(PARSER, "address of: " << left << (lvalue ? " lvalue" : ""));
+			left = checkAddr(left, lvalue);
 			lvalue = false;
-		} 
-		else if (lookahead == '%') 
+		}
+		else if (top.kind == DEREF)
+		{
+			left = checkDeref(left);
+			lvalue = true;
+		}
+		else if (top.kind == SIZE_OF)
 		{
-			match('%');
-			right = prefixExpression(lvalue);
-			left = checkMod(left, right);
+			left = checkSizeOf(left);
 			lvalue = false;
-		} 
+		}
 		else
-			break;
-    }
-	return left;
-}
+		{
+			left = checkTypeCast(left, top.typespec, top.indirection);
+			lvalue = false;
+		}
 
-static Type additiveExpression(bool& lvalue)
-{
-   	Type left = multiplicativeExpression(lvalue);
-   	Type right;
+		node = tree->add(top.kind, top.token, left, lvalue, node);
 
-    while (1) 
+		if (top.kind == SIZE_OF ? foldSizeOf(tree->type(child), value)
+			: tree->constant(child) && foldUnary(top.kind, left,
+				operand, tree->value(child), value))
+			tree->fold(node, value);
+	}
+
+	if ((op = binaryOperator(lookahead)) != nullptr)
 	{
-		if (lookahead == '+') 
-		{
-			match('+');
-			right = multiplicativeExpression(lvalue);
-			left = checkAdd(left, right);
-			lvalue = false;
-		} 
-		else if (lookahead == '-') 
-		{
-			match('-');
-			right = multiplicativeExpression(lvalue);
-			left = checkSub(left, right);
-			lvalue = false;
-		} 
-		else
-			break;
-    }
-	return left;
-}
+		top.kind = BINARY;
+		top.left = reduce(left, lvalue, node, base, op->precedence);
+		top.node = node;
+		top.token = current;
+		top.op = op;
+		pending.push_back(top);
+		match(lookahead);
+		goto operand;
+	}
 
-static Type relationalExpression(bool& lvalue)
-{
-    Type left = additiveExpression(lvalue);
-	Type right;
+	left = reduce(left, lvalue, node, base, 0);
 
-    while (1) 
+	if (pending.size() == base)
+		return left;
+
+	top = pending.back();
+
+	if (top.kind == PAREN)
 	{
-		if (lookahead == LEQ) 
-		{
-			match(LEQ);
-			right = additiveExpression(lvalue);
-			left = checkEQs(left, right, "<=");
-			lvalue = false;
-		} 
-		else if (lookahead == GEQ) 
-		{
-			match(GEQ);
-			right = additiveExpression(lvalue);
-			left = checkEQs(left, right, ">=");
-			lvalue = false;
-		} 
-		else if (lookahead == '<') 
-		{
-			match('<');
-			right = additiveExpression(lvalue);
-			left = checkEQs(left, right, "<");
-			lvalue = false;
-		} 
-		else if (lookahead == '>') 
-		{
-			match('>');
-			right = additiveExpression(lvalue);
-			left = checkEQs(left, right, ">");
-			lvalue = false;
-		} 
+		pending.pop_back();
+		match(')');
+		goto postfix;
+	}
 
-		else
-			break;
-    }
-	return left;
-}
+	if (top.kind == INDEX)
+	{
+		pending.pop_back();
+		left = checkIndex(top.left, left);
+		lvalue = true;
+		tree->link(top.node, node);
+		node = tree->add(INDEX, top.token, left, lvalue, top.node);
+		match(']');
+		goto postfix;
+	}
 
-static Type equalityExpression(bool& lvalue)
-{
-    Type left = relationalExpression(lvalue);
-	Type right;
+	arguments.push_back(left);
+	tree->link(top.last, node);
+	pending.back().last = node;
 
-    while (1) 
+	if (lookahead == ',')
 	{
-		if (lookahead == EQL) 
-		{
-			match(EQL);
-			right = relationalExpression(lvalue);
-			left = checkEQs(left, right, "==");
-			lvalue = false;
-		} 
-		else if (lookahead == NEQ) 
-		{
-			match(NEQ);
-			right = relationalExpression(lvalue);
-			left = checkEQs(left, right, "!=");
-			lvalue = false;
-		} 
-		else
-			break;
-    }
-	return left;
-}
+		match(',');
+		goto operand;
+	}
 
-static Type logicalAndExpression(bool& lvalue)
-{
-    Type left = equalityExpression(lvalue);
+call:
+	top = pending.back();
+	pending.pop_back();
+	TRACE(PARSER, "call: " << top.symbol->name() << " with "
+		<< arguments.size() - top.args << " arguments");
+	match(')');
 
-    while (lookahead == AND) 
+	if (panicking)
 	{
-		match(AND);
-		Type right = equalityExpression(lvalue);
-		left = checkLogical(left, right, "&&"); 
-		lvalue = false;
-    }
+		arguments.resize(top.args);
+		goto unwind;
+	}
+
+	left = checkFuncType(*top.symbol, arguments.data() + top.args,
+		arguments.size() - top.args);
+	lvalue = false;
+	node = tree->add(CALL, top.token, left, lvalue, top.node);
+	arguments.resize(top.args);
+	goto postfix;
 
-    return left;
+unwind:
+	while (pending.size() > base)
+	{
+		if (pending.back().kind == CALL)
+			arguments.resize(pending.back().args);
+
+		pending.pop_back();
+	}
+
+	lvalue = false;
+	node = 0;
+	return Type();
 }
 
-static Type expression(bool& lvalue)
+static Node assignment(bool& lvalue)
 {
-    Type left = logicalAndExpression(lvalue);
+	Node node, right;
+	Type left;
+	unsigned token;
+
+	left = expression(lvalue, node);
+	bool lv_save = lvalue;
+	TRACE(PARSER, "assignment: " << left << (lvalue ? " lvalue" : ""));
 
-    while (lookahead == OR) 
+	if (lookahead == '=')
 	{
-		match(OR);
-		Type right = logicalAndExpression(lvalue);
-		left = checkLogical(left, right, "||");
-		lvalue = false;
-    }
-    return left;
-}
+		token = current;
+		match('=');
+		left = checkAssignment(left, expression(lvalue, right), lv_save);
+		tree->link(node, right);
+		node = tree->add('=', token, left, false, node);
+	}
 
-static void statements(Symbol& func)
-{
-    while (lookahead != '}')
-		statement(func);
+	return node;
 }
 
-static void assignment(bool& lvalue)
+/*
+ * A statement is also parsed without recursion.  The compound, loop, and
+ * if statements whose bodies are being parsed are kept on a stack, along
+ * with the nodes for their parts so far, and when a statement is
+ * complete we finish each statement on the stack that it completes in
+ * turn.  An if statement whose else part is being parsed is marked by
+ * its else.
+ */
+
+struct Enclosing {
+    int kind;
+    unsigned token;
+    Node head, tail;
+};
+
+static thread_local vector<Enclosing> enclosing;
+
+
+/*
+ * Function:	abandon
+ *
+ * Description:	Abandon the statements enclosing a syntax error that we
+ *		could only recover from at the next declaration or the end
+ *		of file, closing their scopes and loops.
+ */
+
+static void abandon(size_t base)
 {
-	cout << "assignment initial:" << lvalue << endl;
-	Type right, left;
-    left = expression(lvalue);
-	bool lv_save = lvalue;
-	cout << "assignment in parser" << lvalue << endl;
+	int kind;
 
-    if (lookahead == '=') 
+	while (enclosing.size() > base)
 	{
-		match('=');
-		right = expression(lvalue);
-		cout << "assignment if stmt" << lvalue << endl;
-		checkAssignment(left, right, lv_save);
-    }
+		kind = enclosing.back().kind;
+		enclosing.pop_back();
+
+		if (kind == '{')
+			release(closeScope());
+		else if (kind == WHILE || kind == FOR)
+			bcount--;
+	}
 }
 
-static void statement(Symbol& func)
+
+/*
+ * Function:	statement
+ *
+ * Description:	Parse and check a statement, and return its tree.  A
+ *		statement with a syntax error is skipped up to its semicolon
+ *		or the closing brace of its block, and the statements
+ *		enclosing it are finished as usual, or, if the error is not
+ *		recovered from within the function, abandoned.
+ */
+
+static Node statement(Symbol& func)
 {
+	size_t base = enclosing.size();
+	Enclosing top;
 	bool lvalue;
-	Type right, left;
+	Node node;
+	Type left;
+
+next:
+	top.kind = lookahead;
+	top.token = current;
+	top.head = top.tail = node = 0;
 
-    if (lookahead == '{')
+	if (panicking)
+		TRACE(PARSER, "skipping statement: line " << context->tokens.line(current));
+	else if (lookahead == '{')
 	{
 		match('{');
 		openScope();
 		declarations();
-		statements(func);
-		closeScope();
-		match('}');
-
-    } else if (lookahead == BREAK) 
+		enclosing.push_back(top);
+	}
+	else if (lookahead == BREAK)
 	{
 		match(BREAK);
-		checkBreak(bcount);
+		left = checkBreak(bcount);
+		node = tree->add(BREAK, top.token, left);
 		match(';');
-
-    } else if (lookahead == RETURN) 
+	}
+	else if (lookahead == RETURN)
 	{
 		match(RETURN);
-		left = expression(lvalue);
+		left = expression(lvalue, node);
 		left = checkReturnType(left, func);
+		node = tree->add(RETURN, top.token, left, false, node);
 		match(';');
-
-    } 
-	else if (lookahead == WHILE) 
+	}
+	else if (lookahead == WHILE)
 	{
 		match(WHILE);
 		match('(');
-		left = expression(lvalue);
+		left = expression(lvalue, node);
 		left = checkIfoWhile(left);
+		append(top.head, top.tail, node);
 		match(')');
 		bcount++;
-		statement(func);
-		bcount--;
-
-    } 
-	else if (lookahead == FOR) 
+		enclosing.push_back(top);
+		goto next;
+	}
+	else if (lookahead == FOR)
 	{
 		match(FOR);
 		match('(');
-	 	assignment(lvalue);
+		append(top.head, top.tail, assignment(lvalue));
 		match(';');
-		left = expression(lvalue);
+		left = expression(lvalue, node);
 		left = checkIfoWhile(left);
+		append(top.head, top.tail, node);
 		match(';');
-		assignment(lvalue);
+		append(top.head, top.tail, assignment(lvalue));
 		match(')');
 		bcount++;
-		statement(func);
-		bcount--;
-
-    } else if (lookahead == IF) 
+		enclosing.push_back(top);
+		goto next;
+	}
+	else if (lookahead == IF)
 	{
 		match(IF);
 		match('(');
-		left = expression(lvalue);
+		left = expression(lvalue, node);
 		left = checkIfoWhile(left);
+		append(top.head, top.tail, node);
 		match(')');
-		statement(func);
+		enclosing.push_back(top);
+		goto next;
+	}
+	else
+	{
+		node = assignment(lvalue);
+		match(';');
+	}
 
-		if (lookahead == ELSE) 
+	if (panicking)
+	{
+		if (lookahead != ';' && lookahead != '}')
 		{
-			match(ELSE);
-			statement(func);
+			abandon(base);
+			return 0;
 		}
 
-    } else 
+		resume(';');
+	}
+
+	while (enclosing.size() > base)
 	{
-		assignment(lvalue);
-		match(';');
-    }
+		Enclosing &outer = enclosing.back();
+		append(outer.head, outer.tail, node);
+
+		if (outer.kind == '{')
+		{
+			if (lookahead != '}')
+				goto next;
+
+			release(closeScope());
+			match('}');
+		}
+		else if (outer.kind == WHILE || outer.kind == FOR)
+			bcount--;
+		else if (outer.kind == IF && lookahead == ELSE)
+		{
+			match(ELSE);
+			outer.kind = ELSE;
+			goto next;
+		}
+
+		node = tree->add(outer.kind == ELSE ? IF : outer.kind, outer.token,
+			Type(), false, outer.head);
+		enclosing.pop_back();
+	}
+
+	return node;
+}
+
+static Node statements(Symbol& func)
+{
+	Node head = 0, tail = 0;
+
+	while (lookahead != '}' && !panicking)
+		append(head, tail, statement(func));
+
+	return head;
 }
 
 static Type parameter()
 {
     int typespec;
     unsigned indirection;
-    string name;
+    Name name;
     Type type;
     typespec = specifier();
     indirection = pointers();
     name = identifier();
     type = Type(typespec, indirection);
-    declareVariable(name, type);
+    if (!panicking)
+	declareVariable(name, type);
     return type;
 }
 
-static Parameters *parameters()
+static Parameters parameters()
 {
-    Parameters *params;
+    Parameters params;
     openScope();
-    params = new Parameters;
-    params->variadic = false;
+    params.variadic = false;
 
     if (lookahead == VOID)
 	match(VOID);
 
     else 
 	{
-		params->types.push_back(parameter());
+		params.types.push_back(parameter());
 
 		while (lookahead == ',') 
 		{
@@ -613,12 +940,12 @@ static Parameters *parameters()
 
 			if (lookahead == ELLIPSIS) 
 			{
-				params->variadic = true;
+				params.variadic = true;
 				match(ELLIPSIS);
 				break;
 			}
 
-	    params->types.push_back(parameter());
+	    params.types.push_back(parameter());
 		}
     }
 
@@ -627,25 +954,31 @@ static Parameters *parameters()
 
 static void globalDeclarator(int typespec)
 {
-    unsigned indirection;
-    string name;
+    unsigned indirection, length;
+    Parameters params;
+    Name name;
     indirection = pointers();
     name = identifier();
 
     if (lookahead == '[') 
 	{
 		match('[');
-		declareVariable(name, Type(typespec, indirection, integer()));
+		length = integer();
+		if (!panicking)
+			declareVariable(name, Type(typespec, indirection, length));
 		match(']');
     } 
 	else if (lookahead == '(') 
 	{
 		match('(');
-		declareFunction(name, Type(typespec, indirection, parameters()));
-		closeParamScope();
+		params = parameters();
+		if (!panicking)
+			declareFunction(name, Type(typespec, indirection, params));
+		release(closeScope());
+		locals.reset();
 		match(')');
     } 
-	else
+	else if (!panicking)
 		declareVariable(name, Type(typespec, indirection));
 }
 
@@ -659,20 +992,230 @@ static void remainingDeclarators(int typespec)
     match(';');
 }
 
+/*
+ * Function:	traceTree
+ *
+ * Description:	Write the tree of a function definition to the tree trace
+ *		channel, one node per line, indented by depth.  The nodes
+ *		are walked with an explicit stack, like the parser, so no
+ *		tree is too deep to write.
+ */
+
+static void traceTree(Node root)
+{
+    static const char *names[] = {
+	"-", "!", "&", "*", "sizeof", "cast", "[]", "call", "++", "--",
+	"function", "unit",
+    };
+
+    vector<pair<Node, unsigned>> stack;
+    unsigned depth;
+    Node node;
+    int kind;
+
+
+    if (!(TRACE_CHANNELS & TRACE_TREE) || !tracing(TRACE_TREE))
+	return;
+
+    ostream &out = traceStream();
+    stack.push_back(make_pair(root, 0));
+
+    while (!stack.empty()) {
+	node = stack.back().first;
+	depth = stack.back().second;
+	stack.pop_back();
+
+	if (tree->next(node) != 0)
+	    stack.push_back(make_pair(tree->next(node), depth));
+
+	if (tree->first(node) != 0)
+	    stack.push_back(make_pair(tree->first(node), depth + 1));
+
+	kind = tree->kind(node);
+	out << string(2 * depth, ' ');
+
+	if (kind < NEGATE)
+	    out << context->tokens.text(tree->token(node));
+	else if (kind == FUNCTION)
+	    out << "function " << context->tokens.text(tree->token(node));
+	else
+	    out << names[kind - NEGATE];
+
+	if (kind != '{' && kind != IF && kind != WHILE && kind != FOR)
+	    out << ": " << tree->type(node);
+
+	if (tree->constant(node) && tree->type(node).isDouble())
+	    out << " = " << tree->value(node).real;
+	else if (tree->constant(node))
+	    out << " = " << tree->value(node).integer;
+
+	out << (tree->lvalue(node) ? " lvalue" : "") << '\n';
+    }
+}
+
+/*
+ * The bodies of the functions may be checked in parallel once every
+ * declaration has been seen.  The translation unit is first parsed with
+ * each function body skipped up to its matching brace and kept as a job,
+ * and with its diagnostics deferred.  The jobs are then checked on a
+ * pool of threads, each with its own parser state, top-level scope, and
+ * list of deferred diagnostics, and the tree of each is grafted into the
+ * tree for the translation unit.  Finally, the diagnostics are reported
+ * in the order in which they would have been reported serially.  The
+ * extent of a function is only certain if it has no syntax errors, so
+ * after any syntax error we start over and check serially instead.
+ */
+
+
+/*
+ * Function:	defer
+ *
+ * Description:	Keep the body of the given function as a job and skip to
+ *		the token after its matching brace, leaving the tokens in
+ *		between to be reached by the thread that checks it.  A body
+ *		without a matching brace is a syntax error.  The job takes
+ *		the arena holding the function's scope with it.
+ */
+
+static void defer(Symbol *func, unsigned start)
+{
+    unsigned end, depth;
+    int kind;
+    Job job;
+
+
+    for (end = current, depth = 0; ; end ++) {
+	kind = context->tokens.kind(end);
+
+	if (kind == '{')
+	    depth ++;
+	else if (kind == '}' && -- depth == 0)
+	    break;
+	else if (kind == DONE) {
+	    failed = true;
+	    return;
+	}
+    }
+
+    job.function = func;
+    job.scope = closeScope();
+    job.arena = move(locals);
+    job.start = start;
+    job.body = current;
+    job.end = end;
+    job.mark = context->outside.size();
+    job.node = 0;
+    job.failed = false;
+    context->jobs.push_back(move(job));
+
+    reached = current = end + 1;
+    lookahead = token(current);
+}
+
+
+/*
+ * Function:	checkDeferred
+ *
+ * Description:	Parse and check the body of a deferred function on this
+ *		thread, and graft its tree into the tree for the unit.  The
+ *		scopes of the body are allocated from the arena of the job,
+ *		which is freed once they are closed.
+ */
+
+static void checkDeferred(Job &job)
+{
+	Node node;
+
+
+	deferred = &job.diagnostics;
+	current = job.body;
+	reached = job.body + 1;
+	lookahead = token(current);
+	panicking = failed = false;
+	quiet = 0;
+
+	allocateFrom(&job.arena);
+	reopenScope(job.scope);
+	match('{');
+	declarations();
+	node = tree->add('{', job.body, Type(), false, statements(*job.function));
+	release(closeScope());
+	job.scope = nullptr;
+	job.arena.clear();
+
+	job.failed = failed || current != job.end;
+	node = tree->add(FUNCTION, job.start, job.function->type(), false, node);
+
+	{
+		lock_guard<mutex> lock(context->grafting);
+		job.node = context->tree.graft(*tree, node);
+	}
+
+	tree->clear();
+}
+
+
+/*
+ * Function:	checkJobs
+ *
+ * Description:	Check deferred functions until there are none left or a
+ *		syntax error has been found in one.  The jobs are taken in
+ *		order from a shared counter, so a thread that finishes its
+ *		job early just takes the next one.  Each thread builds its
+ *		trees in a scratch tree of its own.
+ */
+
+static void checkJobs(CompilerContext *unit)
+{
+    Tree scratch;
+    size_t i;
+
+
+    context = unit;
+    tree = &scratch;
+
+    while (!context->abandoned
+	    && (i = context->nextJob ++) < context->jobs.size()) {
+	checkDeferred(context->jobs[i]);
+
+	if (context->jobs[i].failed)
+	    context->abandoned = true;
+    }
+}
+
+
+/*
+ * Function:	replay
+ *
+ * Description:	Report the given deferred diagnostics.
+ */
+
+static void replay(const vector<Diagnostic> &list, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i ++) {
+	position = list[i].offset;
+	report(list[i].code, list[i].arg);
+    }
+}
+
 static void topLevelDeclaration()
 {
 	Symbol* func;
     int typespec;
-    unsigned indirection;
-    Parameters *params;
-    string name;
+    unsigned indirection, length, start, body;
+    Parameters params;
+    Name name;
+    Node node;
     typespec = specifier();
     indirection = pointers();
+    start = current;
     name = identifier();
     if (lookahead == '[') 
 	{
 		match('[');
-		declareVariable(name, Type(typespec, indirection, integer()));
+		length = integer();
+		if (!panicking)
+			declareVariable(name, Type(typespec, indirection, length));
 		match(']');
 		remainingDeclarators(typespec);
     } 
@@ -684,33 +1227,178 @@ static void topLevelDeclaration()
 		if (lookahead == '{')
 		{
 			func = defineFunction(name, Type(typespec, indirection, params));
+
+			if (context->parallel)
+			{
+				defer(func, start);
+				return;
+			}
+
+			body = current;
 			match('{');
 			declarations();
-			statements(*func);
-			closeScope();
+			node = tree->add('{', body, Type(), false, statements(*func));
+			release(closeScope());
+			locals.reset();
 			match('}');
+			node = tree->add(FUNCTION, start, func->type(), false, node);
+			append(context->definitions, context->lastDefinition, node);
+			traceTree(node);
 		} 
 		else 
 		{
-			closeParamScope();
-			declareFunction(name, Type(typespec, indirection, params));
+			release(closeScope());
+			locals.reset();
+			if (!panicking)
+				declareFunction(name, Type(typespec, indirection, params));
 			remainingDeclarators(typespec);
 		}
     } 
 	else 
 	{
-		declareVariable(name, Type(typespec, indirection));
+		if (!panicking)
+			declareVariable(name, Type(typespec, indirection));
 		remainingDeclarators(typespec);
     }
 }
 
-int main()
+/*
+ * Function:	checkInParallel
+ *
+ * Description:	Parse the translation unit and check its function bodies
+ *		in parallel on the given number of threads.  After a syntax
+ *		error, nothing is reported and everything is put back as it
+ *		was, so that the translation unit can be checked serially.
+ *		The tokens must all have been read, and since the trace
+ *		channels are shared, this is not done in a tracing build.
+ */
+
+static void checkInParallel(unsigned threads)
+{
+    vector<thread> workers;
+    size_t from;
+
+
+    context->parallel = true;
+    deferred = &context->outside;
+
+    while (lookahead != DONE && !failed)
+	topLevelDeclaration();
+
+    deferred = nullptr;
+    context->parallel = false;
+
+    if (!failed) {
+	for (unsigned i = 0; i < threads && i < context->jobs.size(); i ++)
+	    workers.emplace_back(checkJobs, context);
+
+	for (auto &worker : workers)
+	    worker.join();
+    }
+
+    if (failed || context->abandoned) {
+	while (context->outermost != nullptr)
+	    release(closeScope());
+
+	locals.reset();
+
+	for (auto &job : context->jobs)
+	    if (job.scope != nullptr)
+		release(job.scope);
+
+	context->jobs.clear();
+	context->outside.clear();
+	context->nextJob = 0;
+	context->abandoned = failed = false;
+	panicking = false;
+	quiet = 0;
+	tree->clear();
+
+	openScope();
+	reached = current = 0;
+	lookahead = token(current);
+	return;
+    }
+
+    from = 0;
+
+    for (auto &job : context->jobs) {
+	replay(context->outside, from, job.mark);
+	replay(job.diagnostics, 0, job.diagnostics.size());
+	append(context->definitions, context->lastDefinition, job.node);
+	from = job.mark;
+    }
+
+    replay(context->outside, from, context->outside.size());
+    context->jobs.clear();
+}
+
+
+/*
+ * Function:	forget
+ *
+ * Description:	Forget everything about the top-level declarations parsed
+ *		so far that is no longer needed, when the current context is
+ *		streaming its source: their tokens and lines, the tree of
+ *		each function defined, and the diagnostics reported on them,
+ *		which are written out.  The tokens are then numbered from
+ *		the lookahead, so that their indices do not run out however
+ *		long the source.  The declarations themselves are kept in
+ *		the outermost scope.
+ */
+
+static void forget()
 {
+    tree->clear();
+    context->definitions = context->lastDefinition = 0;
+
+    context->tokens.discard(current);
+    reached -= current;
+    current = 0;
+
+    forgetLines(context->tokens.position(current));
+    context->diagnostics.flush();
+}
+
+
+/*
+ * Function:	parse
+ *
+ * Description:	Parse and check the translation unit of the current
+ *		context, whose source must already be open, checking its
+ *		function bodies on the given number of threads if they can
+ *		be, and return whether it had no syntax errors.  The parser
+ *		state of this thread is reset first, since the thread may
+ *		have parsed other translation units before.
+ */
+
+bool parse(unsigned checkers)
+{
+    tree = &context->tree;
+    current = reached = 0;
+    panicking = failed = false;
+    quiet = 0;
+    bcount = 0;
+
+    allocateFrom(&locals);
     openScope();
-    lookahead = yylex();
-    while (lookahead != DONE)
+    lookahead = token(current);
+
+    if (checkers > 1 && context->tokens.done() && !context->streaming
+	    && TRACE_CHANNELS == 0)
+	checkInParallel(checkers);
+
+    while (lookahead != DONE) {
 		topLevelDeclaration();
 
-    closeScope();
-    exit(EXIT_SUCCESS);
+		if (panicking)
+			resume(lookahead == '}' ? '}' : ';');
+
+		if (context->streaming && !context->stopped)
+			forget();
+    }
+
+    tree->add(UNIT, current, Type(), false, context->definitions);
+    release(closeScope());
+    return !failed;
 }
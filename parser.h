@@ -0,0 +1,13 @@
+/*
+ * File:	parser.h
+ *
+ * Description:	This file contains the public function declarations for
+ *		the parser for Simple C.
+ */
+
+# ifndef PARSER_H
+# define PARSER_H
+
+bool parse(unsigned checkers = 1);
+
+# endif /* PARSER_H */
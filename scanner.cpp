@@ -0,0 +1,694 @@
+/*
+ * File:	scanner.cpp
+ *
+ * Description:	This file contains the member function definitions for
+ *		the hand-written scanner for Simple C, which recognizes
+ *		exactly the same tokens as the flex lexer in lexer.l.
+ *
+ *		Whitespace, comments, and identifiers are scanned a vector
+ *		at a time using AVX2 or SSE2, whichever the compiler is
+ *		targeting, with a plain loop as a fallback.  The input is
+ *		always followed by at least SOURCE_PADDING null characters
+ *		so that a vector can be loaded anywhere up to the end of the
+ *		input.  Keywords are recognized with a perfect hash whose
+ *		table is built, and checked to be perfect, at compile time.
+ *
+ *		A mapped source is scanned in place.  Otherwise, the input
+ *		is read in chunks into a buffer of our own, and when a token
+ *		runs into the end of the buffer the unscanned part is moved
+ *		to the front and more input is read.  Either way, we never
+ *		look for newlines, since the lines are indexed separately.
+ */
+
+# include <cassert>
+# include <cctype>
+# include <cstdio>
+# include <cstring>
+# include "tokens.h"
+# include "scanner.h"
+# include "source.h"
+
+# if defined(__AVX2__) || defined(__SSE2__)
+# include <immintrin.h>
+# endif
+
+using namespace std;
+
+
+/*
+ * Vector operations.  A block is as many characters as fit in a vector
+ * register, and a mask has one bit for each character in a block.
+ */
+
+# if defined(__AVX2__)
+
+typedef __m256i Block;
+enum { BLOCKSIZE = 32 };
+
+static inline Block load(const char *p)
+{
+    return _mm256_loadu_si256((const __m256i *) p);
+}
+
+static inline Block equal(Block b, char c)
+{
+    return _mm256_cmpeq_epi8(b, _mm256_set1_epi8(c));
+}
+
+static inline Block between(Block b, char lo, char hi)
+{
+    Block d = _mm256_sub_epi8(b, _mm256_set1_epi8(lo));
+    d = _mm256_subs_epu8(d, _mm256_set1_epi8(hi - lo));
+    return _mm256_cmpeq_epi8(d, _mm256_setzero_si256());
+}
+
+static inline Block either(Block a, Block b)
+{
+    return _mm256_or_si256(a, b);
+}
+
+static inline unsigned mask(Block b)
+{
+    return _mm256_movemask_epi8(b);
+}
+
+# elif defined(__SSE2__)
+
+typedef __m128i Block;
+enum { BLOCKSIZE = 16 };
+
+static inline Block load(const char *p)
+{
+    return _mm_loadu_si128((const __m128i *) p);
+}
+
+static inline Block equal(Block b, char c)
+{
+    return _mm_cmpeq_epi8(b, _mm_set1_epi8(c));
+}
+
+static inline Block between(Block b, char lo, char hi)
+{
+    Block d = _mm_sub_epi8(b, _mm_set1_epi8(lo));
+    d = _mm_subs_epu8(d, _mm_set1_epi8(hi - lo));
+    return _mm_cmpeq_epi8(d, _mm_setzero_si128());
+}
+
+static inline Block either(Block a, Block b)
+{
+    return _mm_or_si128(a, b);
+}
+
+static inline unsigned mask(Block b)
+{
+    return _mm_movemask_epi8(b);
+}
+
+# endif
+
+# ifdef BLOCKSIZE
+
+static_assert(BLOCKSIZE <= SOURCE_PADDING, "padding too small for a block");
+
+static const unsigned FULL = BLOCKSIZE == 32 ? ~0u : (1u << BLOCKSIZE) - 1;
+
+# endif
+
+
+/*
+ * Keywords.  The hash uses the first, second, and last characters and
+ * the length, which happens to separate all of the keywords.
+ */
+
+static constexpr struct {
+    const char *name;
+    unsigned length;
+    int token;
+} keywords[] = {
+    {"auto", 4, AUTO}, {"break", 5, BREAK}, {"case", 4, CASE},
+    {"char", 4, CHAR}, {"const", 5, CONST}, {"continue", 8, CONTINUE},
+    {"default", 7, DEFAULT}, {"do", 2, DO}, {"double", 6, DOUBLE},
+    {"else", 4, ELSE}, {"enum", 4, ENUM}, {"extern", 6, EXTERN},
+    {"float", 5, FLOAT}, {"for", 3, FOR}, {"goto", 4, GOTO},
+    {"if", 2, IF}, {"int", 3, INT}, {"long", 4, LONG},
+    {"register", 8, REGISTER}, {"return", 6, RETURN},
+    {"short", 5, SHORT}, {"signed", 6, SIGNED}, {"sizeof", 6, SIZEOF},
+    {"static", 6, STATIC}, {"struct", 6, STRUCT}, {"switch", 6, SWITCH},
+    {"typedef", 7, TYPEDEF}, {"union", 5, UNION},
+    {"unsigned", 8, UNSIGNED}, {"void", 4, VOID},
+    {"volatile", 8, VOLATILE}, {"while", 5, WHILE},
+};
+
+enum { HASHSIZE = 64, MINKEYWORD = 2, MAXKEYWORD = 8 };
+
+static constexpr unsigned hashKeyword(const char *s, unsigned length)
+{
+    return (5 * (unsigned char) s[0] + 15 * (unsigned char) s[1]
+	+ 7 * (unsigned char) s[length - 1] + length) % HASHSIZE;
+}
+
+struct KeywordTable {
+    const char *names[HASHSIZE];
+    short tokens[HASHSIZE];
+};
+
+static constexpr KeywordTable makeKeywordTable()
+{
+    KeywordTable table = {};
+
+    for (auto &k : keywords) {
+	table.names[hashKeyword(k.name, k.length)] = k.name;
+	table.tokens[hashKeyword(k.name, k.length)] = k.token;
+    }
+
+    return table;
+}
+
+static constexpr KeywordTable keywordTable = makeKeywordTable();
+
+static constexpr bool isPerfect()
+{
+    for (auto &k : keywords)
+	if (keywordTable.names[hashKeyword(k.name, k.length)] != k.name)
+	    return false;
+
+    return true;
+}
+
+static_assert(isPerfect(), "keyword hash has a collision");
+
+
+/*
+ * Function:	keyword
+ *
+ * Description:	Return the token for the given identifier if it is a
+ *		keyword, and ID otherwise.
+ */
+
+static int keyword(const char *s, size_t length)
+{
+    unsigned h;
+
+
+    if (length < MINKEYWORD || length > MAXKEYWORD)
+	return ID;
+
+    h = hashKeyword(s, length);
+
+    if (keywordTable.tokens[h] != 0 && strlen(keywordTable.names[h]) == length)
+	if (memcmp(keywordTable.names[h], s, length) == 0)
+	    return keywordTable.tokens[h];
+
+    return ID;
+}
+
+
+/*
+ * Function:	more
+ *
+ * Description:	Read more input into the buffer when streaming, moving
+ *		everything from START onward to the front of the buffer
+ *		first.  START and P are adjusted to their new positions.
+ *		Return whether any more input was read.
+ */
+
+bool Scanner::more(char *&start, char *&p)
+{
+    size_t from, kept, offset, count;
+
+
+    if (!_streaming)
+	return false;
+
+    from = start - _buffer.data();
+    kept = _limit - start;
+    offset = p - start;
+
+    if (kept + BUFSIZ > _buffer.size() - SOURCE_PADDING)
+	_buffer.resize(2 * (kept + BUFSIZ) + SOURCE_PADDING);
+
+    memmove(_buffer.data(), _buffer.data() + from, kept);
+    count = readSource(_buffer.data() + kept, BUFSIZ);
+
+    _origin += from;
+    _first = start = _buffer.data();
+    p = start + offset;
+    _limit = start + kept + count;
+    memset(_limit, 0, SOURCE_PADDING);
+
+    if (count == 0)
+	_streaming = false;
+
+    return count > 0;
+}
+
+
+/*
+ * Function:	at
+ *
+ * Description:	Return the character K past P, reading more input if
+ *		necessary.  Past the end of the input, this is a null.
+ */
+
+inline int Scanner::at(char *&start, char *&p, size_t k)
+{
+    while (p + k >= _limit && more(start, p))
+	continue;
+
+    return p + k < _limit ? (unsigned char) p[k] : 0;
+}
+
+
+/*
+ * Function:	skipSpace
+ *
+ * Description:	Skip any whitespace starting at P.
+ */
+
+void Scanner::skipSpace(char *&p)
+{
+    char *start;
+
+
+    while (1) {
+# ifdef BLOCKSIZE
+	Block b = load(p);
+	unsigned ws = mask(either(equal(b, ' '), between(b, '\t', '\r')));
+
+	if (ws == FULL) {
+	    p += BLOCKSIZE;
+	    continue;
+	}
+
+	p += __builtin_ctz(~ws);
+# else
+	while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+	    p ++;
+# endif
+
+	start = p;
+
+	if (p < _limit || !more(start, p))
+	    break;
+    }
+}
+
+
+/*
+ * Function:	skipComment
+ *
+ * Description:	Skip the rest of a comment after its beginning, exactly as
+ *		the flex lexer's ignoreComment does.  An unterminated
+ *		comment is diagnosed unless it ends right after a '*'.
+ */
+
+void Scanner::skipComment(char *&p)
+{
+    char *start;
+    int c1, c2;
+
+
+    while (1) {
+# ifdef BLOCKSIZE
+	while (1) {
+	    Block b = load(p);
+	    unsigned stop = mask(either(equal(b, '*'), equal(b, '\0')));
+
+	    if (stop == 0) {
+		p += BLOCKSIZE;
+		continue;
+	    }
+
+	    p += __builtin_ctz(stop);
+	    break;
+	}
+# else
+	while (*p != '*' && *p != '\0')
+	    p ++;
+# endif
+
+	start = p;
+
+	if ((c1 = at(start, p, 0)) == 0) {
+	    if (p < _limit)
+		p ++;
+
+	    _message = UNTERMINATED_COMMENT;
+	    return;
+	}
+
+	p ++;
+
+	while (c1 == '*') {
+	    c2 = at(start, p, 0);
+
+	    if (p < _limit)
+		p ++;
+
+	    if (c2 == '/' || c2 == 0)
+		return;
+
+	    c1 = c2;
+	}
+    }
+}
+
+
+/*
+ * Function:	scanIdentifier
+ *
+ * Description:	Return the end of the identifier starting at START.
+ */
+
+char *Scanner::scanIdentifier(char *&start)
+{
+    char *p = start + 1;
+
+
+    while (1) {
+# ifdef BLOCKSIZE
+	Block b = load(p);
+	unsigned id = mask(either(either(between(b, 'a', 'z'),
+		between(b, 'A', 'Z')), either(between(b, '0', '9'),
+		equal(b, '_'))));
+
+	if (id == FULL) {
+	    p += BLOCKSIZE;
+	    continue;
+	}
+
+	p += __builtin_ctz(~id);
+# else
+	while (isalnum((unsigned char) *p) || *p == '_')
+	    p ++;
+# endif
+
+	if (p < _limit || !more(start, p))
+	    return p;
+    }
+}
+
+
+/*
+ * Function:	scanNumber
+ *
+ * Description:	Return the end of the number starting at START, and
+ *		whether it is an integer or real.  Like flex, we take the
+ *		longest match, so a fraction or exponent with no digits is
+ *		left for the next token.
+ */
+
+char *Scanner::scanNumber(char *&start, int &kind)
+{
+    char *p = start;
+    size_t n;
+
+
+    while (isdigit(at(start, p, 0)))
+	p ++;
+
+    kind = INTEGER;
+
+    if (at(start, p, 0) == '.' && isdigit(at(start, p, 1))) {
+	kind = REAL;
+	p += 2;
+
+	while (isdigit(at(start, p, 0)))
+	    p ++;
+
+	if (at(start, p, 0) == 'e' || at(start, p, 0) == 'E') {
+	    n = at(start, p, 1) == '+' || at(start, p, 1) == '-' ? 2 : 1;
+
+	    if (isdigit(at(start, p, n))) {
+		p += n;
+
+		while (isdigit(at(start, p, 0)))
+		    p ++;
+	    }
+	}
+    }
+
+    return p;
+}
+
+
+/*
+ * Function:	scanQuoted
+ *
+ * Description:	Return the end of the string or character literal
+ *		starting at START, or a null pointer if there is no valid
+ *		literal there.  A character literal must not be empty.
+ */
+
+char *Scanner::scanQuoted(char *&start, char quote)
+{
+    char *p = start + 1;
+    int c;
+
+
+    while (1) {
+	c = at(start, p, 0);
+
+	if (c == quote)
+	    return p - start > 1 || quote == '"' ? p + 1 : nullptr;
+
+	if (c == '\n' || (c == 0 && p >= _limit))
+	    return nullptr;
+
+	if (c == '\\') {
+	    c = at(start, p, 1);
+
+	    if (c == '\n' || (c == 0 && p + 1 >= _limit))
+		return nullptr;
+
+	    p += 2;
+	} else
+	    p ++;
+    }
+}
+
+
+/*
+ * Function:	Scanner::Scanner (constructor)
+ *
+ * Description:	Initialize this scanner with nothing to scan.
+ */
+
+Scanner::Scanner()
+    : _first(nullptr), _cursor(nullptr), _limit(nullptr), _text(nullptr),
+      _length(0), _offset(0), _origin(0), _message(NO_ERROR),
+      _streaming(false)
+{
+}
+
+
+/*
+ * Function:	Scanner::read
+ *
+ * Description:	Scan the next token and return its kind.  Its text,
+ *		offset, and any diagnostic for it are then available until
+ *		the next token is scanned.  Literals are not checked here.
+ */
+
+int Scanner::read()
+{
+    char *start, *p;
+    int c, kind;
+    size_t n;
+
+
+    _message = NO_ERROR;
+    p = _cursor;
+
+    while (1) {
+	skipSpace(p);
+	start = p;
+	c = at(start, p, 0);
+
+	if (c == 0 && p >= _limit) {
+	    kind = DONE;
+	    break;
+	}
+
+	if (isalpha(c) || c == '_') {
+	    p = scanIdentifier(start);
+	    kind = keyword(start, p - start);
+	    break;
+	}
+
+	if (isdigit(c)) {
+	    p = scanNumber(start, kind);
+	    break;
+	}
+
+	if (c == '"' || c == '\'') {
+	    if ((p = scanQuoted(start, c)) == nullptr) {
+		p = start + 1;
+		continue;
+	    }
+
+	    kind = c == '"' ? STRING : CHARACTER;
+	    break;
+	}
+
+	n = 1;
+	kind = c;
+
+	switch (c) {
+	case '/':
+	    if (at(start, start, 1) == '*') {
+		p = start + 2;
+		skipComment(p);
+		continue;
+	    }
+
+	    break;
+
+	case '|': case '&': case '=': case '+':
+	    if (at(start, start, 1) == c) {
+		kind = c == '|' ? OR : c == '&' ? AND : c == '=' ? EQL : INC;
+		n = 2;
+	    }
+
+	    break;
+
+	case '!': case '<': case '>':
+	    if (at(start, start, 1) == '=') {
+		kind = c == '!' ? NEQ : c == '<' ? LEQ : GEQ;
+		n = 2;
+	    }
+
+	    break;
+
+	case '-':
+	    if (at(start, start, 1) == '-' || at(start, start, 1) == '>') {
+		kind = at(start, start, 1) == '-' ? DEC : ARROW;
+		n = 2;
+	    }
+
+	    break;
+
+	case '.':
+	    if (at(start, start, 1) == '.' && at(start, start, 2) == '.') {
+		kind = ELLIPSIS;
+		n = 3;
+	    }
+
+	    break;
+
+	case '*': case '%': case '(': case ')': case '[': case ']':
+	case '{': case '}': case ';': case ':': case ',':
+	    break;
+
+	default:
+	    p = start + 1;
+	    continue;
+	}
+
+	p = start + n;
+	break;
+    }
+
+    _text = start;
+    _length = p - start;
+    _offset = _origin + (start - _first);
+    _cursor = p;
+    return kind;
+}
+
+
+/*
+ * Function:	Scanner::scanBuffer
+ *
+ * Description:	Scan the given buffer in place.  The buffer must be
+ *		followed by at least SOURCE_PADDING null characters.  The
+ *		buffer is never written, so several scanners may scan the
+ *		same buffer at once.
+ */
+
+void Scanner::scanBuffer(char *buf, size_t size)
+{
+    _first = _cursor = buf;
+    _limit = buf + size;
+    _origin = 0;
+    _streaming = false;
+}
+
+
+/*
+ * Function:	Scanner::scanStream
+ *
+ * Description:	Scan the source by reading it in chunks.
+ */
+
+void Scanner::scanStream()
+{
+    _buffer.assign(BUFSIZ + SOURCE_PADDING, 0);
+    _first = _cursor = _limit = _buffer.data();
+    _origin = 0;
+    _streaming = true;
+}
+
+
+/*
+ * Function:	Scanner::seek
+ *
+ * Description:	Continue scanning a buffer from the given offset, which
+ *		must be between two tokens.
+ */
+
+void Scanner::seek(size_t offset)
+{
+    assert(!_streaming && _first + offset <= _limit);
+    _cursor = _first + offset;
+}
+
+
+/*
+ * Function:	Scanner::text (accessor)
+ *
+ * Description:	Return the text of the last token scanned.
+ */
+
+const char *Scanner::text() const
+{
+    return _text;
+}
+
+
+/*
+ * Function:	Scanner::length (accessor)
+ *
+ * Description:	Return the length of the last token scanned.
+ */
+
+size_t Scanner::length() const
+{
+    return _length;
+}
+
+
+/*
+ * Function:	Scanner::offset (accessor)
+ *
+ * Description:	Return the offset in the source of the last token
+ *		scanned.
+ */
+
+size_t Scanner::offset() const
+{
+    return _offset;
+}
+
+
+/*
+ * Function:	Scanner::message (accessor)
+ *
+ * Description:	Return the diagnostic for the last token scanned, or a
+ *		null pointer if there was none.
+ */
+
+Error Scanner::message() const
+{
+    return _message;
+}
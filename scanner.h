@@ -0,0 +1,46 @@
+/*
+ * File:	scanner.h
+ *
+ * Description:	This file contains the class definition for the
+ *		hand-written scanner.  A scanner keeps all of its state to
+ *		itself, so any number of them may be used at once, and is
+ *		used both as an alternative to the flex lexer and to scan a
+ *		mapped source in pieces on several threads.
+ */
+
+# ifndef SCANNER_H
+# define SCANNER_H
+# include <cstddef>
+# include <vector>
+# include "errors.h"
+
+class Scanner {
+    char *_first, *_cursor, *_limit, *_text;
+    size_t _length, _offset, _origin;
+    Error _message;
+    bool _streaming;
+    std::vector<char> _buffer;
+
+    bool more(char *&start, char *&p);
+    int at(char *&start, char *&p, size_t k);
+    void skipSpace(char *&p);
+    void skipComment(char *&p);
+    char *scanIdentifier(char *&start);
+    char *scanNumber(char *&start, int &kind);
+    char *scanQuoted(char *&start, char quote);
+
+public:
+    Scanner();
+
+    void scanBuffer(char *buf, size_t size);
+    void scanStream();
+    void seek(size_t offset);
+    int read();
+
+    const char *text() const;
+    size_t length() const;
+    size_t offset() const;
+    Error message() const;
+};
+
+# endif /* SCANNER_H */
@@ -0,0 +1,52 @@
+/*
+ * File:	scc.cpp
+ *
+ * Description:	This file contains the public function definitions for
+ *		using the compiler as a library.
+ */
+
+# include <cerrno>
+# include <memory>
+# include "parser.h"
+# include "scc.h"
+# include "source.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+
+/*
+ * Function:	check
+ *
+ * Description:	Check the given source, handing each diagnostic to the
+ *		given callback, and return the number of diagnostics, or -1
+ *		with errno set if the source could not be checked at all,
+ *		such as when it is too long.  The source is scanned without
+ *		the lexer, which is shared by the whole process, and the
+ *		context current for this thread is restored afterward.
+ */
+
+int check(string_view source, DiagnosticCallback callback)
+{
+    unique_ptr<CompilerContext> unit(new CompilerContext);
+    CompilerContext *saved = context;
+
+
+    context = unit.get();
+    unit->diagnostics.callback(move(callback));
+    copySource(source);
+
+    if (!unit->stopped) {
+	unit->tokens.readAll(1);
+	parse();
+    }
+
+    context = saved;
+
+    if (unit->error != 0) {
+	errno = unit->error;
+	return -1;
+    }
+
+    return unit->numerrors;
+}
@@ -0,0 +1,20 @@
+/*
+ * File:	scc.h
+ *
+ * Description:	This file contains the public interface to the compiler as
+ *		a library, for programs that embed it.  A source held in
+ *		memory is checked in a context of its own, and each of its
+ *		diagnostics is handed to the given callback rather than
+ *		written anywhere, so any number of sources may be checked at
+ *		once on different threads.  Nothing here ever exits or writes
+ *		to the standard error, whatever the source.
+ */
+
+# ifndef SCC_H
+# define SCC_H
+# include <string_view>
+# include "Diagnostics.h"
+
+int check(std::string_view source, DiagnosticCallback callback);
+
+# endif /* SCC_H */
@@ -0,0 +1,391 @@
+/*
+ * File:	source.cpp
+ *
+ * Description:	This file contains the public and private function and
+ *		variable definitions for reading the source file and
+ *		reporting diagnostics against it.
+ *
+ *		A regular file is mapped into memory and followed by some
+ *		zero padding: flex needs two null characters at the end of
+ *		the buffer, and the hand-written scanner needs to be able
+ *		to load a whole vector at a time without running off the
+ *		end of the mapping.  Anything else is streamed, and the
+ *		lexer reads it a chunk at a time through readSource.
+ *
+ *		Neither lexer counts lines.  Instead, we record where each
+ *		line starts as the source is mapped or read, and a line
+ *		number is found from an offset only when a diagnostic needs
+ *		one.  A mapped file is indexed in a single pass before any
+ *		scanning, and a stream is indexed as each chunk is read.
+ *		Since the lexer may be reading on another thread, the index
+ *		is guarded by a lock, which is taken once per chunk and
+ *		once per lookup.
+ *
+ *		A stream may be too long to index all at once, so the
+ *		starts of the lines before a given offset may be forgotten,
+ *		counting how many were, once nothing more will be reported
+ *		on them.
+ *
+ *		The source, its index, and the diagnostics sink all belong
+ *		to the current context.  A source may also be given as text
+ *		in memory, which is copied so that it can be padded.
+ */
+
+# include <algorithm>
+# include <cassert>
+# include <cerrno>
+# include <functional>
+# include <mutex>
+# include <thread>
+# include <vector>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include "lexer.h"
+# include "source.h"
+# include "CompilerContext.h"
+
+# ifdef __SSE2__
+# include <emmintrin.h>
+# endif
+
+using namespace std;
+
+thread_local size_t position = 0;
+
+
+/*
+ * Function:	findLines
+ *
+ * Description:	Append to STARTS the start of each line that begins after
+ *		a newline in the given text, which is found at the given
+ *		offset in the source.  The newlines are found a vector at a
+ *		time.
+ */
+
+static void findLines(const char *text, size_t length, size_t offset,
+	vector<size_t> &starts)
+{
+    size_t i = 0;
+
+
+# ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    for (; i + 16 <= length; i += 16) {
+	__m128i b = _mm_loadu_si128((const __m128i *) (text + i));
+	unsigned bits = _mm_movemask_epi8(_mm_cmpeq_epi8(b, newline));
+
+	while (bits != 0) {
+	    starts.push_back(offset + i + __builtin_ctz(bits) + 1);
+	    bits &= bits - 1;
+	}
+    }
+# endif
+
+    for (; i < length; i ++)
+	if (text[i] == '\n')
+	    starts.push_back(offset + i + 1);
+}
+
+
+/*
+ * Function:	indexLines
+ *
+ * Description:	Index the lines that begin in the given text, which is
+ *		found at the given offset in the source.
+ */
+
+static void indexLines(const char *text, size_t length, size_t offset)
+{
+    lock_guard<mutex> lock(context->indexing);
+    findLines(text, length, offset, context->lines);
+}
+
+
+/*
+ * Function:	indexSource
+ *
+ * Description:	Index the lines of the mapped source, dividing it evenly
+ *		among the given number of threads.  Each thread finds the
+ *		lines in its part separately and the parts are then joined
+ *		in order.
+ */
+
+static void indexSource(unsigned threads)
+{
+    vector<vector<size_t>> parts(threads);
+    vector<thread> workers;
+    size_t begin, end, size;
+    char *source;
+
+
+    source = context->source;
+    size = context->sourcesize;
+
+    if (threads <= 1) {
+	indexLines(source, size, 0);
+	return;
+    }
+
+    for (unsigned i = 0; i < threads; i ++) {
+	begin = size * i / threads;
+	end = size * (i + 1) / threads;
+	workers.emplace_back(findLines, source + begin, end - begin, begin,
+	    ref(parts[i]));
+    }
+
+    for (auto &worker : workers)
+	worker.join();
+
+    lock_guard<mutex> lock(context->indexing);
+
+    for (auto &part : parts)
+	context->lines.insert(context->lines.end(), part.begin(), part.end());
+}
+
+
+/*
+ * Function:	mapSource
+ *
+ * Description:	Map a regular file of the given size into memory and have
+ *		the lexer scan it in place, returning whether the mapping
+ *		succeeded.  We first reserve enough anonymous zero pages for
+ *		the file plus its padding and then map the file over the
+ *		front of them.  The mapping is private and writable since
+ *		the lexers temporarily terminate each yytext with a null,
+ *		and is populated up front to avoid taking a fault on every
+ *		page.  The lines are indexed using the given number of
+ *		threads.
+ */
+
+static bool mapSource(int fd, size_t size, unsigned threads)
+{
+    long pagesize;
+    size_t length;
+    void *base;
+
+
+    if (lseek(fd, 0, SEEK_CUR) != 0)
+	return false;
+
+    pagesize = sysconf(_SC_PAGESIZE);
+    length = (size + SOURCE_PADDING + pagesize - 1) / pagesize * pagesize;
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (base == MAP_FAILED)
+	return false;
+
+    if (mmap(base, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_FIXED | MAP_POPULATE, fd, 0) == MAP_FAILED) {
+	munmap(base, length);
+	return false;
+    }
+
+    madvise(base, length, MADV_SEQUENTIAL);
+    context->source = (char *) base;
+    context->sourcesize = size;
+    context->mapped = length;
+    indexSource(threads);
+    scanBuffer(context->source, size);
+    return true;
+}
+
+
+/*
+ * Function:	openSource
+ *
+ * Description:	Open the named source file for the lexer, or use the
+ *		standard input if no file is named.  A regular file is
+ *		memory-mapped and scanned without copying.  Anything else,
+ *		such as a pipe or terminal, is streamed through the lexer's
+ *		own buffer.  A context that is streaming its source streams
+ *		even a regular file, so that no more of it is held in memory
+ *		than the lexer is scanning.  A regular file that is too long
+ *		to hold all at once is refused up front rather than after
+ *		reading up to the limit.  The given number of threads may
+ *		be used to index a mapped file.
+ */
+
+void openSource(const char *filename, unsigned threads)
+{
+    struct stat st;
+    int fd = 0;
+
+
+    if (filename != nullptr)
+	context->name = filename;
+
+    if (filename != nullptr && (fd = open(filename, O_RDONLY)) < 0) {
+	fatal(errno);
+	return;
+    }
+
+    if (!context->streaming && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+	    && st.st_size > 0) {
+	if ((size_t) st.st_size > SOURCE_LIMIT) {
+	    close(fd);
+	    fatal(EFBIG);
+	    return;
+	}
+
+	if (mapSource(fd, st.st_size, threads))
+	    return;
+    }
+
+    context->input = fd;
+    scanStream();
+}
+
+
+/*
+ * Function:	copySource
+ *
+ * Description:	Use a padded copy of the given text as the source.  It
+ *		is indexed, but left for the caller to scan, since the
+ *		lexer may be busy with another context.  The text may not
+ *		be longer than the limit.
+ */
+
+void copySource(string_view text)
+{
+    if (text.size() > SOURCE_LIMIT) {
+	fatal(EFBIG);
+	return;
+    }
+
+    context->copy.assign(text.size() + SOURCE_PADDING, 0);
+    copy(text.begin(), text.end(), context->copy.begin());
+    context->source = context->copy.data();
+    context->sourcesize = text.size();
+    indexSource(1);
+}
+
+
+/*
+ * Function:	readSource
+ *
+ * Description:	Read the next chunk of a streamed source into the given
+ *		buffer and index its lines, returning the number of
+ *		characters read or zero at the end of the source.  As with
+ *		read, a terminal gives us only a line at a time.  An error
+ *		in reading stops the context and ends the source there.
+ */
+
+size_t readSource(char *buf, size_t size)
+{
+    ssize_t count;
+
+
+    while ((count = read(context->input, buf, size)) < 0)
+	if (errno != EINTR) {
+	    fatal(errno);
+	    return 0;
+	}
+
+    indexLines(buf, count, context->streamed);
+    context->streamed += count;
+    return count;
+}
+
+
+/*
+ * Function:	fatal
+ *
+ * Description:	Stop the current context because of the given system error
+ *		in reading its source, keeping the error for whoever is
+ *		compiling the unit to report.
+ */
+
+void fatal(int error)
+{
+    context->error = error;
+    context->stopped = true;
+}
+
+
+/*
+ * Function:	forgetLines
+ *
+ * Description:	Forget the starts of the lines before the line containing
+ *		the given offset in the source, which must already have
+ *		been read.
+ */
+
+void forgetLines(size_t offset)
+{
+    vector<size_t> &lines = context->lines;
+    lock_guard<mutex> lock(context->indexing);
+    size_t count;
+
+
+    count = upper_bound(lines.begin(), lines.end(), offset) - lines.begin();
+    lines.erase(lines.begin(), lines.begin() + count - 1);
+    context->forgotten += count - 1;
+}
+
+
+/*
+ * Function:	lineOf
+ *
+ * Description:	Return the line containing the given offset in the
+ *		source, which must already have been read, and must not be
+ *		on a line that has been forgotten.
+ */
+
+unsigned lineOf(size_t offset)
+{
+    vector<size_t> &lines = context->lines;
+    lock_guard<mutex> lock(context->indexing);
+
+
+    assert(offset >= lines.front());
+
+    return context->forgotten
+	+ (upper_bound(lines.begin(), lines.end(), offset) - lines.begin());
+}
+
+
+/*
+ * Function:	columnOf
+ *
+ * Description:	Return the column of the given offset in the source,
+ *		counting from one.
+ */
+
+unsigned columnOf(size_t offset)
+{
+    unsigned line = lineOf(offset);
+    lock_guard<mutex> lock(context->indexing);
+    return offset - context->lines[line - context->forgotten - 1] + 1;
+}
+
+
+/*
+ * Function:	report
+ *
+ * Description:	Report the diagnostic with the given code and argument at
+ *		the current position through the diagnostics sink, unless
+ *		this thread's diagnostics are being deferred.  Once the
+ *		sink is full, there is no point in going on, so the context
+ *		is stopped, and nothing more is reported after that.
+ */
+
+void report(Error code, string_view arg)
+{
+    if (context->stopped)
+	return;
+
+    if (deferred != nullptr) {
+	deferred->push_back(Diagnostic{position, code, string(arg)});
+	return;
+    }
+
+    if (context->diagnostics.emit(position, code, arg))
+	context->numerrors ++;
+
+    if (context->diagnostics.full())
+	context->stopped = true;
+}
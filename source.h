@@ -0,0 +1,46 @@
+/*
+ * File:	source.h
+ *
+ * Description:	This file contains the public function and variable
+ *		declarations for reading the source file and reporting
+ *		diagnostics against it.  These are shared by both lexers.
+ *
+ *		Positions in the source are byte offsets.  Line and column
+ *		numbers are only computed from an offset when needed, using
+ *		a table of the offsets at which each line starts.  The
+ *		source and its table belong to the current context.  When
+ *		a long source is streamed, the starts of the lines before
+ *		a given offset may be forgotten once no diagnostic can be
+ *		reported on them.
+ *
+ *		The tokens read from the source keep 32-bit offsets into
+ *		it, so no more of it than the limit may be held at once:
+ *		all of it, unless it is streamed.  A source that cannot be
+ *		read, or is too long, is a fatal error, which stops the
+ *		context rather than the program.
+ */
+
+# ifndef SOURCE_H
+# define SOURCE_H
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+# include "errors.h"
+
+enum { SOURCE_PADDING = 64 };
+
+const size_t SOURCE_LIMIT = UINT32_MAX - 1;
+
+extern thread_local size_t position;
+
+extern void openSource(const char *filename = nullptr,
+	unsigned threads = 1);
+extern void copySource(std::string_view text);
+extern size_t readSource(char *buf, size_t size);
+extern void fatal(int error);
+extern void forgetLines(size_t offset);
+extern unsigned lineOf(size_t offset);
+extern unsigned columnOf(size_t offset);
+extern void report(Error code, std::string_view arg = {});
+
+# endif /* SOURCE_H */
@@ -14,15 +14,17 @@ using namespace std;
 /*
  * Function:	parseString
  *
- * Description:	Parse a string contains C-style escape sequences.  An
- *		invalid escape sequence is detected, as is an overflow in
- *		an octal or hexadecimal escape sequence.
+ * Description:	Parse a string contains C-style escape sequences,
+ *		appending the result to the given string rather than
+ *		returning a new one so that the caller can reuse its
+ *		storage.  An invalid escape sequence is detected, as is an
+ *		overflow in an octal or hexadecimal escape sequence.
  */
 
-string parseString(const string &s, bool &invalid, bool &overflow)
+void parseString(string_view s, string &result, bool &invalid, bool &overflow)
 {
     unsigned start, val;
-    string result;
+    auto next = [&](unsigned i) { return i + 1 < s.size() ? s[i + 1] : 0; };
 
 
     invalid = false;
@@ -32,7 +34,7 @@ string parseString(const string &s, bool &invalid, bool &overflow)
 	if (s[i] == '\\') {
 	    i ++;
 
-	    switch(s[i]) {
+	    switch(i < s.size() ? s[i] : 0) {
 	    case 'a':
 		result += '\a';
 		break;
@@ -70,11 +72,11 @@ string parseString(const string &s, bool &invalid, bool &overflow)
 		start = i;
 
 		while (1) {
-		    if (s[i + 1] >= '0' && s[i + 1] <= '9')
+		    if (next(i) >= '0' && next(i) <= '9')
 			val = val * 16 + (s[++ i] - '0');
-		    else if (s[i + 1] >= 'a' && s[i + 1] <= 'f')
+		    else if (next(i) >= 'a' && next(i) <= 'f')
 			val = val * 16 + (s[++ i] - 'a' + 10);
-		    else if (s[i + 1] >= 'A' && s[i + 1] <= 'F')
+		    else if (next(i) >= 'A' && next(i) <= 'F')
 			val = val * 16 + (s[++ i] - 'A' + 10);
 		    else
 			break;
@@ -93,10 +95,10 @@ string parseString(const string &s, bool &invalid, bool &overflow)
 	    case '4': case '5': case '6': case '7':
 		val = s[i] - '0';
 
-		if (s[i + 1] >= '0' && s[i + 1] <= '7')
+		if (next(i) >= '0' && next(i) <= '7')
 		    val = val * 8 + (s[++ i] - '0');
 
-		if (s[i + 1] >= '0' && s[i + 1] <= '7')
+		if (next(i) >= '0' && next(i) <= '7')
 		    val = val * 8 + (s[++ i] - '0');
 
 		if (val > UCHAR_MAX)
@@ -107,14 +109,30 @@ string parseString(const string &s, bool &invalid, bool &overflow)
 
 	    default:
 		invalid = true;
-		result += s[i];
+		result += i < s.size() ? s[i] : 0;
 		break;
 	    }
 
 	} else
 	    result += s[i];
     }
+}
+
+
+/*
+ * Function:	parseString
+ *
+ * Description:	Parse a string contains C-style escape sequences.  An
+ *		invalid escape sequence is detected, as is an overflow in
+ *		an octal or hexadecimal escape sequence.
+ */
+
+string parseString(const string &s, bool &invalid, bool &overflow)
+{
+    string result;
+
 
+    parseString(s, result, invalid, overflow);
     return result;
 }
 
@@ -8,7 +8,10 @@
 # ifndef STRING_H
 # define STRING_H
 # include <string>
+# include <string_view>
 
+void parseString(std::string_view s, std::string &result, bool &invalid,
+		 bool &overflow);
 std::string parseString(const std::string &s);
 std::string parseString(const std::string &s, bool &invalid, bool &overflow);
 std::string escapeString(const std::string &s);
@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# File:		tests/bench.sh
+#
+# Description:	Run the benchmarks on generated inputs and report the
+#		results.  Nothing is checked; the numbers are only for
+#		comparing one build or machine with another.  The size of
+#		the inputs may be given in megabytes as BENCH_MB.  The
+#		default build is not optimized, so for numbers worth
+#		comparing, build with something like:
+#
+#		make clean bench CXXFLAGS="-O2 -g -Wall -std=c++17"
+#
+
+MB=${BENCH_MB:-64}
+LEXER=${LEXER:-flex}
+WORKDIR=${TMPDIR:-/tmp}/scc-bench.$$
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR || exit 1
+sh tests/generate.sh functions $MB > $WORKDIR/functions.c || exit 1
+sh tests/generate.sh expressions $MB > $WORKDIR/expressions.c || exit 1
+SIZE=`wc -c < $WORKDIR/functions.c`
+
+
+# Add the rate at which the source was read to what the driver reports.
+
+rate() {
+    awk '{ printf "%s, %.1f MB/s\n", $0, '$SIZE' / $3 / 1e6 }'
+}
+
+
+# Reading the source with each lexer: a regular file is mapped and
+# scanned in place, while a pipe, or any file when streaming, is read
+# through the lexer's own buffer.
+
+for LEX in flex simd; do
+    echo "Reading a $MB MB source with the $LEX lexer ..."
+    echo -n "  mapped:	"; tests/lex-$LEX -t $WORKDIR/functions.c | rate
+    echo -n "  streamed:	"
+    tests/lex-$LEX -t -fstream $WORKDIR/functions.c | rate
+    echo -n "  piped:	"; cat $WORKDIR/functions.c | tests/lex-$LEX -t | rate
+done
+
+
+# Reading a mapped source in chunks on several threads.  The lines are
+# indexed on the same number of threads.
+
+echo "Reading a $MB MB source on several threads ..."
+
+for THREADS in 1 2 4 8 16; do
+    echo -n "  $THREADS:	"
+    tests/lex-simd -t -flex-threads=$THREADS $WORKDIR/functions.c | rate
+done
+
+
+# Parsing and checking expressions, found by taking the time to read the
+# tokens from the time to compile the whole source.
+
+echo "Parsing and checking a $MB MB source of expressions ..."
+
+tests/lex-$LEXER -t $WORKDIR/expressions.c > $WORKDIR/lexing
+tests/measure $WORKDIR/compiling ./scc $WORKDIR/expressions.c
+
+awk '{ tokens = $1; lexing = $3; getline < "'$WORKDIR/compiling'"
+    printf "  %.3f s, %.1f ns per token\n", $1 - lexing,
+	($1 - lexing) / tokens * 1e9 }' $WORKDIR/lexing
+
+
+# Peak memory per byte of source when compiling, which includes the
+# tokens, the tree, and the mapped source itself.  When streaming, only
+# the declaration being checked is kept, along with the names declared
+# so far.
+
+echo "Compiling a $MB MB source ..."
+
+for RUN in functions expressions "functions -fstream"; do
+    set -- $RUN
+    SIZE=`wc -c < $WORKDIR/$1.c`
+    tests/measure $WORKDIR/compiling ./scc $2 $WORKDIR/$1.c
+    read TIME MEMORY < $WORKDIR/compiling
+    echo "  $RUN:	$TIME s, $MEMORY KB," `echo $MEMORY $SIZE |
+	awk '{ printf "%.1f bytes per byte", $1 * 1024 / $2 }'`
+done
@@ -0,0 +1,36 @@
+/*
+ * constants.c
+ *
+ * Each return gives the value its expression must be folded to, or a
+ * dash if it must be left unfolded.  The sizes are those of LP64.
+ */
+
+int x;
+char c;
+double d;
+
+int sizes(void)
+{
+    return sizeof c;			/* 1 */
+    return sizeof -c;			/* 4 */
+    return sizeof ((char) x);		/* 1 */
+    return sizeof -(char) x;		/* 4 */
+    return sizeof !(char) x;		/* 4 */
+    return sizeof -(char) 1;		/* 4 */
+    return sizeof -(double) c;		/* 8 */
+    return sizeof (x + c);		/* 4 */
+}
+
+int values(void)
+{
+    return -(char) 1;			/* -1 */
+    return -(char) 128;			/* 128 */
+    return !(char) 256;			/* 1 */
+    return 6 * 7;			/* 42 */
+    return -2147483647 - 1;		/* -2147483648 */
+    return 2147483647 + 1;		/* - */
+    return -(-2147483647 - 1);		/* - */
+    return 65536 * 65536;		/* - */
+    return 7 / 0;			/* - */
+    return x + 1;			/* - */
+}
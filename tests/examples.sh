@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# File:		tests/examples.sh
+#
+# Description:	Run the compiler on each of the examples in examples.tar
+#		and compare what it reports with the expected diagnostics,
+#		just as CHECKSUB.sh does for a submission.  Each example is
+#		read both from the standard input and as a named file, since
+#		the two may be read in different ways, and each is also run
+#		with each of the options that change only how the compiler
+#		goes about its work, since none of them may change what it
+#		reports.
+#
+
+SCC=${SCC:-$PWD/scc}
+WORKDIR=${TMPDIR:-/tmp}/scc-examples.$$
+FAILED=0
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR && tar -C $WORKDIR -xf examples.tar || exit 1
+
+echo "Running examples ..."
+
+cd $WORKDIR/examples && for FILE in *.c; do
+    for OPTION in "" -fpipeline -flex-threads=4 -fcheck-threads=4 -fstream; do
+	echo -n "$FILE $OPTION ... "
+	(ulimit -t 1; $SCC $OPTION) < $FILE 2>&1 >/dev/null |
+	    cmp -s - `basename $FILE .c`.err && echo ok ||
+	    { echo failed; FAILED=1; }
+	(ulimit -t 1; $SCC $OPTION $FILE) 2>&1 >/dev/null |
+	    cmp -s - `basename $FILE .c`.err ||
+	    { echo "$FILE $OPTION ... failed when named"; FAILED=1; }
+    done
+done
+
+exit $FAILED
@@ -0,0 +1,60 @@
+/*
+ * File:	tests/fold.cpp
+ *
+ * Description:	This file contains a driver that checks a source and
+ *		writes out, for each return statement in it, its line and
+ *		the value to which its expression was folded, or a dash if
+ *		it was not, so that constant folding can be compared with
+ *		what C gives.  The source is named on the command line or
+ *		read from the standard input.
+ */
+
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include "parser.h"
+# include "source.h"
+# include "tokens.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+static CompilerContext unit;
+
+
+int main(int argc, char *argv[])
+{
+    const Tree &tree = unit.tree;
+    bool checked;
+    Node child;
+
+
+    context = &unit;
+    openSource(argc > 1 ? argv[1] : nullptr);
+
+    if (!unit.stopped)
+	unit.tokens.readAll();
+
+    checked = !unit.stopped && parse();
+
+    if (unit.error != 0) {
+	fprintf(stderr, "%s: %s\n", unit.name, strerror(unit.error));
+	exit(EXIT_FAILURE);
+    }
+
+    for (Node n = 1; n < tree.size(); n ++) {
+	if (tree.kind(n) != RETURN || (child = tree.first(n)) == 0)
+	    continue;
+
+	printf("%u: ", unit.tokens.line(tree.token(n)));
+
+	if (!tree.constant(child))
+	    printf("-\n");
+	else if (tree.type(child).isDouble())
+	    printf("%g\n", tree.value(child).real);
+	else
+	    printf("%d\n", tree.value(child).integer);
+    }
+
+    exit(checked ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+#
+# File:		tests/fold.sh
+#
+# Description:	Check constants.c and compare the value to which each of
+#		its returned expressions is folded with the value given in
+#		the comment after it, or a dash if it must be left unfolded.
+#
+
+FOLD=${FOLD:-$PWD/tests/fold}
+WORKDIR=${TMPDIR:-/tmp}/scc-fold.$$
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR || exit 1
+
+echo "Folding constants ..."
+
+awk -F'/\\* *| *\\*/' '/^ *return/ { print NR ": " $2 }' tests/constants.c \
+    > $WORKDIR/expected || exit 1
+
+$FOLD tests/constants.c > $WORKDIR/folded || exit 1
+diff $WORKDIR/expected $WORKDIR/folded && echo ok
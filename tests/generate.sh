@@ -0,0 +1,101 @@
+#!/bin/sh
+#
+# File:		tests/generate.sh
+#
+# Description:	Write a generated Simple C translation unit of about the
+#		given number of megabytes to the standard output, for the
+#		benchmarks and the tests that need large inputs.  Every
+#		unit generated is free of errors.
+#
+#		usage: generate.sh kind megabytes
+#
+#		functions	many small function definitions, each
+#				followed by a global variable
+#		expressions	functions made up of long expressions,
+#				with every binary and unary operator at
+#				random depths of nesting
+#		declarations	a few function definitions, and then the
+#				same globals and prototypes declared over
+#				and over, so that however large the unit,
+#				the names declared in it are the same
+#
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 kind megabytes" 1>&2
+    exit 1
+fi
+
+case $1 in
+functions)
+    exec awk -v limit=$(($2 * 1000000)) 'BEGIN {
+	for (n = i = 0; n < limit; i ++) {
+	    s = sprintf("int f%d(int a, int b) {\n", i)
+	    s = s "    int x, y, z[10];\n    double d;\n"
+	    s = s "    x = 0; y = a; d = 0.5;\n"
+	    for (j = 0; j < 20; j ++) {
+		s = s "    while (x < b) { x = x + 1; y = y * 3 + x - a / 7;"
+		s = s " d = d + x * 2.5; if (y > 1000) y = y - 1000;"
+		s = s " z[x % 10] = y; }\n"
+	    }
+	    s = s sprintf("    return x + y;\n}\n\nint g%d;\n\n", i)
+	    printf "%s", s
+	    n += length(s)
+	}
+    }' ;;
+
+expressions)
+    exec awk -v limit=$(($2 * 1000000)) '
+    function operand(depth,	r, u, s) {
+	r = int(rand() * 8)
+	if (depth > 4 || r < 3)
+	    return substr("abcde", int(rand() * 5) + 1, 1)
+	if (r == 3)
+	    return int(rand() * 100)
+	if (r == 4) {
+	    u = substr("-!", int(rand() * 2) + 1, 1)
+	    s = operand(depth + 1)
+	    return u == "-" && s ~ /^-/ ? u " " s : u s
+	}
+	return "(" expression(depth + 1) ")"
+    }
+    function expression(depth,	s, i, n) {
+	s = operand(depth)
+	n = int(rand() * 4) + 1
+	for (i = 0; i < n; i ++)
+	    s = s " " ops[int(rand() * nops) + 1] " " operand(depth)
+	return s
+    }
+    BEGIN {
+	srand(1)
+	nops = split("|| && == != < > <= >= + - * / %", ops, " ")
+	for (n = i = 0; n < limit; i ++) {
+	    s = sprintf("int f%d(int a, int b, int c) {\n", i)
+	    s = s "    int d, e, x;\n    d = a; e = b; x = c;\n"
+	    for (j = 0; j < 50; j ++)
+		s = s "    x = " expression(0) ";\n"
+	    s = s "    return x;\n}\n\n"
+	    printf "%s", s
+	    n += length(s)
+	}
+    }' ;;
+
+declarations)
+    exec awk -v limit=$(($2 * 1000000)) 'BEGIN {
+	for (i = 0; i < 10; i ++) {
+	    printf "int f%d(int a, int b) {\n    int x;\n    x = a;\n", i
+	    printf "    while (x < b) x = x * 2 + 1;\n    return x;\n}\n\n"
+	}
+
+	for (i = 0; i < 10; i ++)
+	    s = s sprintf("int g%d, *p%d, a%d[10];\ndouble d%d;\n", i, i, i, i)
+	for (i = 0; i < 10; i ++)
+	    s = s sprintf("int f%d(int a, int b);\n", i)
+
+	for (n = 0; n < limit; n += length(s))
+	    printf "%s\n", s
+    }' ;;
+
+*)
+    echo "$0: unknown kind $1" 1>&2
+    exit 1 ;;
+esac
@@ -0,0 +1,119 @@
+/*
+ * File:	tests/lex.cpp
+ *
+ * Description:	This file contains a driver that reads every token of a
+ *		source into a token buffer with whichever lexer it is linked
+ *		with, just as the compiler would read them, and either
+ *		writes each token out, so that the lexers can be compared,
+ *		or with -t reports how quickly they were read.  The source
+ *		is named on the command line or read from the standard
+ *		input.  It takes the compiler's -flex-threads=N and -fstream
+ *		options.
+ */
+
+# include <algorithm>
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include "source.h"
+# include "tokens.h"
+# include "CompilerContext.h"
+
+using namespace std;
+
+static CompilerContext unit;
+
+
+/*
+ * Function:	quote
+ *
+ * Description:	Write the given text with any unprintable characters and
+ *		backslashes escaped, so that each token fits on one line.
+ */
+
+static void quote(string_view s)
+{
+    for (unsigned char c : s)
+	if (c == '\\' || c < ' ' || c > '~')
+	    printf("\\%03o", c);
+	else
+	    putchar(c);
+}
+
+
+/*
+ * Function:	dump
+ *
+ * Description:	Write out each token read, one per line, with its offset,
+ *		kind, any diagnostic for it, text, and value.
+ */
+
+static void dump()
+{
+    TokenBuffer &tokens = unit.tokens;
+    int kind;
+
+
+    for (unsigned i = 0; i < tokens.size(); i ++) {
+	kind = tokens.kind(i);
+	printf("%zu %d %d ", tokens.position(i), kind, tokens.message(i));
+	quote(tokens.text(i));
+
+	if (kind == INTEGER || kind == CHARACTER)
+	    printf(" %lu", tokens.integer(i));
+	else if (kind == REAL)
+	    printf(" %.17g", tokens.real(i));
+	else if (kind == STRING) {
+	    putchar(' ');
+	    quote(tokens.chars(i));
+	}
+
+	putchar('\n');
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *filename = nullptr;
+    unsigned threads = 1;
+    bool timing = false;
+    double seconds;
+
+
+    context = &unit;
+
+    for (int i = 1; i < argc; i ++)
+	if (strcmp(argv[i], "-t") == 0)
+	    timing = true;
+	else if (strncmp(argv[i], "-flex-threads=", 14) == 0)
+	    threads = max(atoi(argv[i] + 14), 1);
+	else if (strcmp(argv[i], "-fstream") == 0)
+	    unit.streaming = true;
+	else if (filename == nullptr)
+	    filename = argv[i];
+
+    auto start = chrono::steady_clock::now();
+    openSource(filename, threads);
+
+    if (unit.source != nullptr && threads > 1)
+	unit.tokens.readAll(threads);
+    else if (!unit.stopped)
+	unit.tokens.readAll();
+
+    if (unit.error != 0) {
+	fprintf(stderr, "%s: %s\n", unit.name, strerror(unit.error));
+	exit(EXIT_FAILURE);
+    }
+
+    seconds = chrono::duration<double>(chrono::steady_clock::now()
+	- start).count();
+
+    if (timing)
+	printf("%u tokens, %.3f s\n", unit.tokens.size(), seconds);
+    else
+	dump();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# File:		tests/lexdiff.sh
+#
+# Description:	Compare the tokens read by the flex lexer with those read
+#		by the hand-written scanner, which must be identical in
+#		kind, offset, diagnostic, text, and value.  The inputs are
+#		the examples, every kind of token in lexemes.c, and a
+#		generated source, each read as a mapped file, as a streamed
+#		file, and through a pipe.  A mapped file is also read in
+#		chunks on several threads, which must give exactly the same
+#		tokens as reading it from start to finish.  With the inputs
+#		this small, many of the chunks begin within a comment,
+#		string, or other token.
+#
+
+WORKDIR=${TMPDIR:-/tmp}/scc-lexdiff.$$
+FAILED=0
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR && tar -C $WORKDIR -xf examples.tar || exit 1
+cp tests/lexemes.c $WORKDIR/examples || exit 1
+sh tests/generate.sh functions 1 > $WORKDIR/examples/functions.c || exit 1
+
+echo "Comparing lexers ..."
+
+for FILE in $WORKDIR/examples/*.c; do
+    echo -n "`basename $FILE` ... "
+    tests/lex-flex $FILE > $WORKDIR/flex
+    RESULT=ok
+
+    for LEX in "tests/lex-simd" "tests/lex-simd -fstream" "tests/lex-flex -fstream"; do
+	$LEX $FILE | cmp -s - $WORKDIR/flex || RESULT="failed ($LEX)"
+    done
+
+    for LEX in tests/lex-simd tests/lex-flex; do
+	cat $FILE | $LEX | cmp -s - $WORKDIR/flex || RESULT="failed (| $LEX)"
+    done
+
+    for THREADS in 2 3 4 7 16; do
+	tests/lex-flex -flex-threads=$THREADS $FILE | cmp -s - $WORKDIR/flex ||
+	    RESULT="failed (-flex-threads=$THREADS)"
+    done
+
+    echo $RESULT
+    [ "$RESULT" = ok ] || FAILED=1
+done
+
+exit $FAILED
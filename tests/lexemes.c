@@ -0,0 +1,27 @@
+/*
+ * Every kind of token, including the malformed ones, for comparing the
+ * lexers.  This is not a valid program.
+ */
+
+auto break case char const continue default do double else enum extern
+float for goto if int long register return short signed sizeof static
+struct switch typedef union unsigned void volatile while
+
+|| && == != <= >= ++ -- -> ... - | = < > + * / % & ! ( ) [ ] { } ; : . ,
+a->b a.b a...b a--b a---b a+++b a/**/b a//b
+x _x x_ _ __ X9 int0 while_ intx iffy
+
+0 7 42 0777 2147483647 4294967295 18446744073709551615
+18446744073709551616 99999999999999999999999999
+1.5 0.0 3.25e-2 6.02E23 1e5 1.e5 .5 1.5e400 1.5e-400 12.34e+5
+
+'a' '\n' '\t' '\\' '\'' '"' '\0' '\777' '\q' 'ab' '' '
+"" "a" "tab\tnewline\n" "quote\"" "back\\slash" "\q" "\777" "\0x"
+"unterminated
+
+@ $ ` # \ ~ ^ ?
+
+/* a comment
+   over several lines with * and / and "quotes" */ int after;
+/***/ /* ** */ /*/ still a comment */
+/* unterminated at the end of the file
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# File:		tests/lexer.sh
+#
+# Description:	Check that lexer.cpp is exactly what flex generates from
+#		lexer.l, so that the two cannot drift apart through edits
+#		made to the generated lexer by hand.  The lexer can only be
+#		compared when the same version of flex that generated it is
+#		installed; otherwise the test is skipped.
+#
+
+LEX=${LEX:-lex}
+WORKDIR=${TMPDIR:-/tmp}/scc-lexer.$$
+
+trap 'rm -rf $WORKDIR' 0
+
+echo -n "Comparing lexer.cpp with lexer.l ... "
+
+WANT=`sed -n 's/^#define YY_FLEX_[A-Z]*_VERSION //p' lexer.cpp |
+    tr '\n' . | sed 's/\.$//'`
+
+if ! command -v $LEX >/dev/null; then
+    echo "skipped (needs flex $WANT, $LEX not found)"
+    exit 77
+fi
+
+HAVE=`$LEX --version | sed 's/.* //'`
+
+if [ "$HAVE" != "$WANT" ]; then
+    echo "skipped (needs flex $WANT, found $HAVE)"
+    exit 77
+fi
+
+mkdir -p $WORKDIR && $LEX $LFLAGS -t lexer.l > $WORKDIR/lexer.cpp || exit 1
+cmp -s $WORKDIR/lexer.cpp lexer.cpp && echo ok && exit 0
+
+echo "failed (regenerate it with make -B lexer.cpp)"
+exit 1
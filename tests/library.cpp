@@ -0,0 +1,154 @@
+/*
+ * File:	tests/library.cpp
+ *
+ * Description:	This file contains a driver that checks each of the
+ *		sources named on the command line through the library, first
+ *		one at a time and then all at once on the given number of
+ *		threads, and reports whether every thread got exactly the
+ *		diagnostics and result that checking them one at a time did.
+ *		Each thread checks every source, starting from a different
+ *		one, so that different sources are checked at the same time.
+ *		Every thread also checks a source too long to be checked,
+ *		which must fail with EFBIG.
+ *
+ *		usage: library threads file ...
+ */
+
+# include <algorithm>
+# include <cerrno>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <deque>
+# include <fstream>
+# include <sstream>
+# include <string>
+# include <thread>
+# include <vector>
+# include <sys/mman.h>
+# include "scc.h"
+# include "source.h"
+
+using namespace std;
+
+struct Result {
+    int count, error;
+    string diagnostics;
+
+    bool operator ==(const Result &that) const {
+	return count == that.count && error == that.error &&
+	    diagnostics == that.diagnostics;
+    }
+};
+
+
+/*
+ * Function:	run
+ *
+ * Description:	Check the given source and return the result, with its
+ *		diagnostics written out one per line, and the error if it
+ *		could not be checked.
+ */
+
+static Result run(string_view source)
+{
+    Result result;
+
+
+    result.count = check(source, [&](unsigned line, unsigned column,
+	    string_view message) {
+	result.diagnostics += to_string(line) + ":" + to_string(column) + ": ";
+	result.diagnostics += message;
+	result.diagnostics += '\n';
+    });
+
+    result.error = result.count < 0 ? errno : 0;
+    return result;
+}
+
+
+int main(int argc, char *argv[])
+{
+    deque<string> texts;
+    vector<const char *> names;
+    vector<string_view> sources;
+    vector<Result> expected;
+    vector<vector<Result>> results;
+    vector<thread> workers;
+    unsigned threads;
+    bool failed = false;
+    void *huge;
+
+
+    if (argc < 3) {
+	fprintf(stderr, "usage: %s threads file ...\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    threads = max(atoi(argv[1]), 1);
+
+    for (int i = 2; i < argc; i ++) {
+	ifstream file(argv[i]);
+	stringstream text;
+
+	if (!(text << file.rdbuf())) {
+	    perror(argv[i]);
+	    exit(EXIT_FAILURE);
+	}
+
+	texts.push_back(text.str());
+	sources.push_back(texts.back());
+	names.push_back(argv[i]);
+    }
+
+    huge = mmap(nullptr, SOURCE_LIMIT + 1, PROT_READ,
+	MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (huge == MAP_FAILED) {
+	perror("mmap");
+	exit(EXIT_FAILURE);
+    }
+
+    sources.push_back(string_view((char *) huge, SOURCE_LIMIT + 1));
+    names.push_back("(too long)");
+
+    for (auto source : sources)
+	expected.push_back(run(source));
+
+    if (expected.back().count != -1 || expected.back().error != EFBIG) {
+	printf("%s ... failed (%d)\n", names.back(), expected.back().count);
+	exit(EXIT_FAILURE);
+    }
+
+    results.assign(threads, vector<Result>(sources.size()));
+
+    for (unsigned t = 0; t < threads; t ++)
+	workers.emplace_back([&, t] {
+	    for (unsigned i = 0; i < sources.size(); i ++) {
+		unsigned k = (t + i) % sources.size();
+		results[t][k] = run(sources[k]);
+	    }
+	});
+
+    for (auto &worker : workers)
+	worker.join();
+
+    for (unsigned k = 0; k < sources.size(); k ++) {
+	unsigned t = 0;
+
+	while (t < threads && results[t][k] == expected[k])
+	    t ++;
+
+	printf("%s ... ", names[k]);
+
+	if (t < threads) {
+	    printf("failed (thread %u)\n", t);
+	    failed = true;
+	} else if (expected[k].count < 0)
+	    printf("ok (%s)\n", strerror(expected[k].error));
+	else
+	    printf("ok (%d)\n", expected[k].count);
+    }
+
+    exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
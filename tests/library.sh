@@ -0,0 +1,23 @@
+#!/bin/sh
+#
+# File:		tests/library.sh
+#
+# Description:	Check the examples, every kind of token in lexemes.c, and
+#		a generated source through the library, one at a time and
+#		then on several threads at once.  Every thread must get
+#		exactly the diagnostics and result that checking them one at
+#		a time did, and must fail to check a source that is too long.
+#
+
+LIBRARY=${LIBRARY:-$PWD/tests/library}
+WORKDIR=${TMPDIR:-/tmp}/scc-library.$$
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR && tar -C $WORKDIR -xf examples.tar || exit 1
+cp tests/lexemes.c $WORKDIR/examples || exit 1
+sh tests/generate.sh functions 1 > $WORKDIR/examples/functions.c || exit 1
+
+echo "Checking sources through the library ..."
+
+cd $WORKDIR/examples && $LIBRARY 4 *.c
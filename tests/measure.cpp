@@ -0,0 +1,72 @@
+/*
+ * File:	tests/measure.cpp
+ *
+ * Description:	This file contains a driver that runs a command and
+ *		records how long it took and the most memory it had
+ *		resident at once, so that the scripts need not depend on
+ *		any particular time(1).  The command inherits our standard
+ *		input and output, and its status becomes ours.
+ *
+ *		usage: measure file command [argument ...]
+ *
+ *		The elapsed seconds and peak resident kilobytes are written
+ *		on one line to the given file.
+ */
+
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <sys/resource.h>
+# include <sys/wait.h>
+# include <unistd.h>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    struct rusage usage;
+    double seconds;
+    int status;
+    pid_t pid;
+    FILE *fp;
+
+
+    if (argc < 3) {
+	fprintf(stderr, "usage: %s file command [argument ...]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    if ((pid = fork()) < 0) {
+	perror("fork");
+	exit(EXIT_FAILURE);
+    }
+
+    if (pid == 0) {
+	execvp(argv[2], argv + 2);
+	perror(argv[2]);
+	_exit(127);
+    }
+
+    if (wait4(pid, &status, 0, &usage) < 0) {
+	perror("wait4");
+	exit(EXIT_FAILURE);
+    }
+
+    seconds = chrono::duration<double>(chrono::steady_clock::now()
+	- start).count();
+
+    if ((fp = fopen(argv[1], "w")) == nullptr) {
+	perror(argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    fprintf(fp, "%.3f %ld\n", seconds, usage.ru_maxrss);
+    fclose(fp);
+
+    if (WIFSIGNALED(status))
+	exit(128 + WTERMSIG(status));
+
+    exit(WEXITSTATUS(status));
+}
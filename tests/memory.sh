@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# File:		tests/memory.sh
+#
+# Description:	Compile generated sources of growing size, piped through
+#		the compiler while it streams them, and check that its peak
+#		memory stays the same however long the source.  The sources
+#		declare the same names over and over, so nothing that must
+#		be kept grows with their size.  Each run must stay under a
+#		ceiling, and none may use more than a little more than the
+#		first.  The sizes may be given in megabytes as MEMORY_MB,
+#		the ceiling in kilobytes as MEMORY_LIMIT, and the growth
+#		allowed over the first run in kilobytes as MEMORY_GROWTH.
+#
+
+SCC=${SCC:-$PWD/scc}
+SIZES=${MEMORY_MB:-1 8}
+LIMIT=${MEMORY_LIMIT:-8192}
+GROWTH=${MEMORY_GROWTH:-256}
+WORKDIR=${TMPDIR:-/tmp}/scc-memory.$$
+FIRST=
+FAILED=0
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR || exit 1
+
+echo "Streaming long sources ..."
+
+for N in $SIZES; do
+    echo -n "$N MB ... "
+
+    if ! sh tests/generate.sh declarations $N |
+	    tests/measure $WORKDIR/$N $SCC -fstream; then
+	echo failed
+	FAILED=1
+	continue
+    fi
+
+    read TIME MEMORY < $WORKDIR/$N
+    FIRST=${FIRST:-$MEMORY}
+
+    if [ $MEMORY -gt $LIMIT ]; then
+	echo "failed ($MEMORY KB, more than $LIMIT KB)"
+	FAILED=1
+    elif [ $MEMORY -gt $(($FIRST + $GROWTH)) ]; then
+	echo "failed ($MEMORY KB, more than $GROWTH KB over $FIRST KB)"
+	FAILED=1
+    else
+	echo "ok ($TIME s and $MEMORY KB)"
+    fi
+done
+
+exit $FAILED
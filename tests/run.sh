@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# File:		tests/run.sh
+#
+# Description:	Run each of the given tests and summarize the results.  As
+#		with automake, a test that exits with 77 could not be run
+#		here and is reported as skipped rather than passed; any
+#		other nonzero status is a failure.  We fail if any test did.
+#
+#		usage: run.sh test ...
+#
+
+PASSED=0
+SKIPPED=
+FAILED=
+
+for TEST in "$@"; do
+    sh $TEST
+    case $? in
+    0)	PASSED=$(($PASSED + 1)) ;;
+    77)	SKIPPED="$SKIPPED $TEST" ;;
+    *)	FAILED="$FAILED $TEST" ;;
+    esac
+done
+
+echo
+echo "$PASSED passed, `echo $SKIPPED | wc -w` skipped," \
+    "`echo $FAILED | wc -w` failed"
+
+for TEST in $SKIPPED; do
+    echo "SKIPPED: $TEST"
+done
+
+for TEST in $FAILED; do
+    echo "FAILED: $TEST"
+done
+
+[ -z "$FAILED" ]
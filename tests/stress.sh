@@ -0,0 +1,74 @@
+#!/bin/sh
+#
+# File:		tests/stress.sh
+#
+# Description:	Compile sources nested to pathological depths: nested
+#		parentheses, chains of unary operators, nested blocks, and
+#		nested if and while statements.  Each must compile without
+#		error at a depth of a million, in time and memory linear in
+#		its depth, which we take to mean that a quarter of the depth
+#		takes at least an eighth of the time and memory.  The depth
+#		may be given as STRESS_DEPTH.
+#
+
+SCC=${SCC:-$PWD/scc}
+DEPTH=${STRESS_DEPTH:-1000000}
+WORKDIR=${TMPDIR:-/tmp}/scc-stress.$$
+FAILED=0
+
+trap 'rm -rf $WORKDIR' 0
+
+mkdir -p $WORKDIR || exit 1
+
+
+# Write a function with a statement nested to the given depth in the
+# given way.
+
+generate() {
+    awk -v kind=$1 -v depth=$2 'BEGIN {
+	if (kind == "parentheses") {
+	    left = "("; inner = "a"; right = ")"; before = "a = "
+	} else if (kind == "unary") {
+	    left = "- ! "; inner = "a"; depth /= 2; before = "a = "
+	} else if (kind == "blocks") {
+	    left = "{ "; inner = "a = 1;"; right = " }"
+	} else {
+	    left = kind " (a) "; inner = "a = 1;"
+	}
+
+	printf "int f(int a) {\n    %s", before
+	for (i = 0; i < depth; i ++)
+	    printf "%s", left
+	printf "%s", inner
+	for (i = 0; i < depth; i ++)
+	    printf "%s", right
+	printf "%s\n    return a;\n}\n", before != "" ? ";" : ""
+    }'
+}
+
+echo "Compiling deeply nested sources ..."
+
+for KIND in parentheses unary blocks if while; do
+    echo -n "$KIND ... "
+    RESULT=ok
+
+    for N in $(($DEPTH / 4)) $DEPTH; do
+	generate $KIND $N > $WORKDIR/$KIND.c || exit 1
+	tests/measure $WORKDIR/$KIND.$N $SCC $WORKDIR/$KIND.c ||
+	    RESULT="failed at depth $N"
+    done
+
+    if [ "$RESULT" = ok ]; then
+	RESULT=`cat $WORKDIR/$KIND.$(($DEPTH / 4)) $WORKDIR/$KIND.$DEPTH |
+	    awk '{ time[NR] = $1; memory[NR] = $2 } END {
+		printf "%s (%.2f s and %d KB, then %.2f s and %d KB)",
+		    time[2] <= 8 * time[1] + 0.1 && \
+		    memory[2] <= 8 * memory[1] ? "ok" : "failed",
+		    time[1], memory[1], time[2], memory[2] }'`
+    fi
+
+    echo $RESULT
+    case $RESULT in ok*) ;; *) FAILED=1 ;; esac
+done
+
+exit $FAILED
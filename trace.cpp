@@ -0,0 +1,149 @@
+/*
+ * File:	trace.cpp
+ *
+ * Description:	This file contains the definitions for the debugging trace
+ *		channels.  The set of enabled channels is read once from
+ *		the SCC_TRACE environment variable, and all channels share
+ *		a buffered sink on the standard output.  Each thread has a
+ *		sink of its own, so tracing needs no locking, and a thread's
+ *		output is written when its buffer fills or it exits.
+ */
+
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include "trace.h"
+
+using namespace std;
+
+static const struct {
+    const char *name;
+    int channel;
+} channels[] = {
+    {"lexer", TRACE_LEXER},
+    {"parser", TRACE_PARSER},
+    {"checker", TRACE_CHECKER},
+    {"types", TRACE_TYPES},
+    {"tree", TRACE_TREE},
+};
+
+
+/*
+ * Class:	TraceBuffer
+ *
+ * Description:	A stream buffer that collects trace output in a large
+ *		fixed buffer and writes it to the standard output only when
+ *		the buffer fills up or the program exits.  We never flush
+ *		on a newline.
+ */
+
+class TraceBuffer : public streambuf {
+    char _buffer[1 << 16];
+
+protected:
+    int overflow(int c) override;
+    int sync() override;
+
+public:
+    TraceBuffer();
+    ~TraceBuffer();
+};
+
+
+TraceBuffer::TraceBuffer()
+{
+    setp(_buffer, _buffer + sizeof(_buffer));
+}
+
+
+TraceBuffer::~TraceBuffer()
+{
+    sync();
+}
+
+
+int TraceBuffer::overflow(int c)
+{
+    sync();
+
+    if (c != EOF) {
+	*pptr() = c;
+	pbump(1);
+    }
+
+    return c;
+}
+
+
+int TraceBuffer::sync()
+{
+    fwrite(pbase(), 1, pptr() - pbase(), stdout);
+    setp(_buffer, _buffer + sizeof(_buffer));
+    return 0;
+}
+
+
+/*
+ * Function:	enabledChannels
+ *
+ * Description:	Parse the SCC_TRACE environment variable into a mask of
+ *		channels.  Unknown channel names are silently ignored.
+ */
+
+static int enabledChannels()
+{
+    const char *s, *end;
+    int mask = 0;
+    size_t length;
+
+
+    if ((s = getenv("SCC_TRACE")) == nullptr)
+	return 0;
+
+    while (*s != '\0') {
+	end = strchr(s, ',');
+	length = end != nullptr ? end - s : strlen(s);
+
+	if (length == 3 && strncmp(s, "all", 3) == 0)
+	    mask = ~0;
+
+	for (auto &c : channels)
+	    if (strlen(c.name) == length && strncmp(s, c.name, length) == 0)
+		mask |= c.channel;
+
+	s += length;
+
+	if (*s == ',')
+	    s ++;
+    }
+
+    return mask;
+}
+
+
+/*
+ * Function:	tracing
+ *
+ * Description:	Return whether the given channel was selected at run time.
+ */
+
+bool tracing(int channel)
+{
+    static int mask = enabledChannels();
+    return (mask & channel) != 0;
+}
+
+
+/*
+ * Function:	traceStream
+ *
+ * Description:	Return the stream shared by all trace channels on the
+ *		calling thread.
+ */
+
+ostream &traceStream()
+{
+    thread_local TraceBuffer buffer;
+    thread_local ostream stream(&buffer);
+    return stream;
+}
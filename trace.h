@@ -0,0 +1,46 @@
+/*
+ * File:	trace.h
+ *
+ * Description:	This file contains the declarations for the debugging
+ *		trace channels.  Each channel covers one phase of the
+ *		compiler and is written using the TRACE macro:
+ *
+ *		    TRACE(CHECKER, "checkAdd: " << left << ", " << right);
+ *
+ *		Channels are compiled in by defining TRACE_CHANNELS as a
+ *		mask of the channels wanted (e.g., -DTRACE_CHANNELS=0x1f for
+ *		all of them).  A channel that is not compiled in costs
+ *		nothing: its condition is a constant false and the whole
+ *		statement is discarded.  The compiled-in channels are then
+ *		selected at run time with the SCC_TRACE environment
+ *		variable, which holds a comma-separated list of channel
+ *		names or "all".
+ *
+ *		Trace output goes to the standard output through a large
+ *		buffer that is only written when full or at exit, so
+ *		tracing never flushes once per line.
+ */
+
+# ifndef TRACE_H
+# define TRACE_H
+# include <ostream>
+
+enum {
+    TRACE_LEXER = 1, TRACE_PARSER = 2, TRACE_CHECKER = 4, TRACE_TYPES = 8,
+    TRACE_TREE = 16
+};
+
+# ifndef TRACE_CHANNELS
+# define TRACE_CHANNELS 0
+# endif
+
+# define TRACE(channel, args)						\
+    do {								\
+	if ((TRACE_CHANNELS & TRACE_##channel) && tracing(TRACE_##channel))\
+	    traceStream() << args << '\n';				\
+    } while (0)
+
+bool tracing(int channel);
+std::ostream &traceStream();
+
+# endif /* TRACE_H */
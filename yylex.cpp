@@ -0,0 +1,85 @@
+/*
+ * File:	yylex.cpp
+ *
+ * Description:	This file contains the lexical analyzer interface on top
+ *		of the hand-written scanner.  It is a drop-in alternative to
+ *		the flex lexer in lexer.l, selected by building with "make
+ *		LEXER=simd", and provides exactly the same yylex, yytext,
+ *		yyleng, and yyoffset interface.
+ */
+
+# include "tokens.h"
+# include "lexer.h"
+# include "scanner.h"
+# include "source.h"
+# include "trace.h"
+
+using namespace std;
+
+char *yytext;
+size_t yyleng, yyoffset;
+
+static Scanner scanner;
+static char hold;
+
+
+/*
+ * Function:	yylex
+ *
+ * Description:	Return the next token, leaving its text in yytext.  As
+ *		with flex, yytext is terminated by temporarily replacing the
+ *		character after it with a null.
+ */
+
+int yylex()
+{
+    Error error;
+    int kind;
+
+
+    if (yytext != nullptr)
+	yytext[yyleng] = hold;
+
+    kind = scanner.read();
+    yytext = (char *) scanner.text();
+    yyleng = scanner.length();
+    yyoffset = scanner.offset();
+
+    if ((error = scanner.message()))
+	lexerror = error;
+
+    if ((error = checkLiteral(kind, string_view(yytext, yyleng), yylval)))
+	lexerror = error;
+
+    hold = yytext[yyleng];
+    yytext[yyleng] = 0;
+
+    TRACE(LEXER, "line " << lineOf(yyoffset) << ", column "
+	<< columnOf(yyoffset) << ": " << yytext);
+    return kind;
+}
+
+
+/*
+ * Function:	scanBuffer
+ *
+ * Description:	Scan the given buffer in place.  The buffer must be
+ *		followed by at least SOURCE_PADDING null characters.
+ */
+
+void scanBuffer(char *buf, size_t size)
+{
+    scanner.scanBuffer(buf, size);
+}
+
+
+/*
+ * Function:	scanStream
+ *
+ * Description:	Scan the source by reading it in chunks.
+ */
+
+void scanStream()
+{
+    scanner.scanStream();
+}